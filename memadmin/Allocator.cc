@@ -24,5 +24,31 @@ void Allocator::setSize(int new_size)
 	//std::cout << "Allocator geheugen op " << size << " eenheden ingesteld\n";//DEBUG
 }
 
+// Allocate several areas: one at a time
+int	Allocator::allocBatch(const int *sizes, int n, Area **out)
+{
+	require(n >= 0);
+	int  got = 0;
+	for (int k = 0 ; k < n ; ++k) {
+		if ((out[k] = alloc(sizes[k])) != 0)
+			++got;
+	}
+	return got;
+}
+
+// Free several areas: one at a time
+void	Allocator::freeBatch(Area **areas, int n)
+{
+	require(n >= 0);
+	for (int k = 0 ; k < n ; ++k)
+		free(areas[k]);
+}
+
+// By default we can not tell what the free space looks like
+bool	Allocator::freeSpace(FreeSpace&)
+{
+	return false;
+}
+
 
 // vim:sw=4:ai:aw:ts=4:
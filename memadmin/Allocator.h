@@ -11,6 +11,35 @@
  *  @version 2.1	2009/02/22
  */
 
+/** @class FreeSpace
+ * Een overzicht van het vrije geheugen van een allocator (zie Allocator::freeSpace).
+ */
+struct FreeSpace
+{
+	int		threshold;	///< vrije gebieden kleiner dan dit zijn "onbruikbaar"
+	int		total;		///< total free units
+	int		largest;	///< the largest free area
+	int		areas;		///< number of free areas
+	int		small;		///< number of free areas < threshold
+
+	/// @param threshold	free areas smaller than this are "unusable"
+	explicit FreeSpace(int threshold = 0)
+		: threshold(threshold), total(0), largest(0), areas(0), small(0) {}
+
+	/// Count one free area of 'n' units.
+	void	add(int n)
+	{
+		if (n <= 0)
+			return;
+		total += n;
+		++areas;
+		if (n > largest)
+			largest = n;
+		if (n < threshold)
+			++small;
+	}
+};
+
 /** @class Allocator
  * Beschrijft de interface van een geheugenbeheer class/module.
  */
@@ -57,9 +86,31 @@ public:
 	virtual void  free(Area *) = 0;			///< Application geeft een Area weer terug aan geheugenbeheer
 	virtual void  report() = 0;				///< Report performance statistics
 
+	// Afgeleide classes MOGEN de volgende methodes herdefinieren,
+	// b.v. om een aantal aanvragen in een keer af te handelen.
+	// De standaard versies doen gewoon een alloc of free per gebied.
+
+	/// Vraag om een aantal gebieden tegelijk (b.v. alles voor een request).
+	/// @param sizes	de gewenste omvang van elk gebied
+	/// @param n		het aantal gebieden
+	/// @param out		hier komen de gebieden (of 0 als dat gebied niet lukte)
+	/// @returns		hoeveel gebieden er gegeven zijn
+	virtual int   allocBatch(const int *sizes, int n, Area **out);
+
+	/// Geef een aantal gebieden tegelijk terug.
+	/// @param areas	de gebieden (allemaal != 0)
+	/// @param n		het aantal gebieden
+	virtual void  freeBatch(Area **areas, int n);
+
+	/// Tel de vrije gebieden zoals de allocator ze zelf ziet: de gebieden
+	/// die hij doorzoekt, dus zonder wat door afronden binnen een
+	/// uitgegeven blok verloren gaat. De standaard versie weet het niet.
+	/// @param fs	hier worden de vrije gebieden bij opgeteld
+	/// @returns	false als de allocator dit niet kan vertellen
+	virtual bool  freeSpace(FreeSpace& fs);
+
 	// ... en hier komen straks misschien nog andere functies ...
 	// ... om b.v. de overhead te bepalen ...
-	// ... of de fragmentatie graad ...
 	//
 
 };
@@ -6,6 +6,32 @@
 // Eigen includes
 #include "asserts.h"	// for: require()
 #include "Area.h"		// class Area
+#include "Pool.h"		// class Pool
+
+
+// The pool for all Area descriptors
+static	Pool&	areaPool()
+{
+	static Pool  pool(sizeof(Area));
+	return pool;
+}
+
+// Get memory for a new Area descriptor
+void	*Area::operator new(size_t n)
+{
+	if (Pool::isEnabled() && (n == sizeof(Area)))
+		return areaPool().get();
+	return ::operator new(n);
+}
+
+// Release the memory of an Area descriptor
+void	 Area::operator delete(void *p)
+{
+	if (Pool::isEnabled())
+		areaPool().put(p);
+	else
+		::operator delete(p);
+}
 
 
 // Maak een Area ...
@@ -9,6 +9,7 @@
  *  @version 3.1	2013/12/14
  */
 
+#include <cstddef>		// for: size_t
 #include <iostream>		// for: std::ostream
 #include "asserts.h"	// for: require()
 
@@ -55,6 +56,16 @@ public:
 	/// @note	Het object waar xp naar verwijst wordt gedelete!
 	void   join(Area *xp);
 
+	/// Verschuif het gebied over 'delta' eenheden,
+	/// b.v. van de adressen van een arena naar die van het geheel (zie Sharded).
+	/// @param	delta	hoeveel eenheden (mag negatief zijn)
+	void   shift(int delta)	{ base += delta; ends += delta; }
+
+	/// Area descriptors come from a Pool when the pools are enabled
+	/// (see Pool::setEnabled), otherwise from the system allocator.
+	static void	*operator new(size_t n);
+	static void	 operator delete(void *p);
+
 
 	// ====== !! Nu komt wat C++ magie !! ======
 
@@ -74,7 +85,7 @@ public:
 	{
 	public:
 		inline 	/// "Call" operator to compare two areas by address
-		bool operator()(const Area *ap, const Area *bp) {
+		bool operator()(const Area *ap, const Area *bp) const {
 			require((ap != 0) && (bp != 0));
 			return ap->base < bp->base;
 		}
@@ -86,19 +97,33 @@ public:
 	{
 	public:
 		inline	/// "Call" operator to compare two areas by size ascending
-		bool operator()(const Area *ap, const Area *bp) {
+		bool operator()(const Area *ap, const Area *bp) const {
 			require((ap != 0) && (bp != 0));
 			return ap->size < bp->size;
 		}
 	};
 
+	/// @class orderBySizeThenAddress
+	/// Sorting functor for Area's by size ascending,
+	/// areas of equal size are ordered by address.
+	class orderBySizeThenAddress
+	{
+	public:
+		inline	/// "Call" operator to compare two areas by size, then by address
+		bool operator()(const Area *ap, const Area *bp) const {
+			require((ap != 0) && (bp != 0));
+			return (ap->size < bp->size)
+				|| ((ap->size == bp->size) && (ap->base < bp->base));
+		}
+	};
+
 	/// @class orderBySizeDescending
 	/// Sorting functor for Area's by size descending
 	class orderBySizeDescending
 	{
 	public:
 		inline	/// "Call" operator to compare two areas by size descending
-		bool operator()(const Area *ap, const Area *bp) {
+		bool operator()(const Area *ap, const Area *bp) const {
 			require((ap != 0) && (bp != 0));
 			return ap->size >= bp->size;
 		}
@@ -0,0 +1,46 @@
+/** @file AreaChecker.cc
+ * De implementatie van AreaChecker.
+ */
+
+#include "main.h"
+#include "AreaChecker.h"
+
+
+// Forget everything
+void	AreaChecker::reset(int size)
+{
+	used.clear();
+	this->size = size;
+}
+
+// Register an area handed out by 'alloc'
+void	AreaChecker::given(const Area *ap)
+{
+	require(ap != 0);
+	int  b = ap->getBase();
+	check(b >= 0 && ap->getLast() < size);		// inside our memory
+	// The first area in use that starts after b ...
+	UsedMap::iterator  i = used.upper_bound(b);
+	check(i == used.end() || i->first > ap->getLast());		// ... may not start inside ap,
+	// ... and the one before it may not reach into ap
+	if (i != used.begin()) {
+		UsedMap::iterator  p = i;
+		--p;
+		check(p->first + p->second <= b);
+	}
+	used.insert(i, UsedMap::value_type(b, ap->getSize()));
+}
+
+// Verify and unregister an area given back to 'free'
+void	AreaChecker::taken(const Area *ap)
+{
+	require(ap != 0);
+	int  b = ap->getBase();
+	check(b >= 0 && ap->getLast() < size);		// out-of-range free ?
+	UsedMap::iterator  i = used.find(b);
+	check(i != used.end());						// double free, or not one of ours ?
+	check(i->second == ap->getSize());			// part of an area, or more than that ?
+	used.erase(i);
+}
+
+// vim:sw=4:ai:aw:ts=4:
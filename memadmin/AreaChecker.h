@@ -0,0 +1,56 @@
+#pragma once
+#ifndef	__AreaChecker_h__
+#define	__AreaChecker_h__	1.0
+
+/** @file AreaChecker.h
+ *  @brief An O(log n) sanity check for 'free' in check mode.
+ */
+
+#include <map>			// the STL std::map<> container
+#include "Area.h"		// class Area
+
+
+/// @class AreaChecker
+/// Een goedkope controle voor check mode.
+/// In plaats van elk teruggegeven gebied met alle vrije gebieden te
+/// vergelijken houdt de checker, gesorteerd op adres, de gebieden bij die
+/// door 'alloc' zijn uitgedeeld. Binnen [0,size) is dat precies het
+/// complement van de vrije ruimte: een gebied dat niet exact zo is uitgedeeld
+/// overlapt dus vrije ruimte (een dubbele of gedeeltelijke free), en een
+/// gebied buiten [0,size) hoort helemaal niet bij ons.
+/// Beide controles kosten O(log n) en de checker hoeft niets te weten
+/// van hoe een allocator zijn vrije ruimte splitst en samenvoegt.
+/// @note Zet check mode aan voordat er iets is uitgedeeld,
+///		  anders zijn de oudere gebieden onbekend.
+class	AreaChecker
+{
+public:
+
+	AreaChecker() : size(0) {}
+
+	/// Forget everything, for a memory of 'size' units
+	void	reset(int size);
+
+	/// Register an area handed out by 'alloc'.
+	/// It must lie inside our memory and may not overlap
+	/// any other area that is still in use.
+	void	given(const Area *ap);
+
+	/// Verify and unregister an area that is given back to 'free'.
+	/// It must lie inside our memory and be exactly an area
+	/// that was handed out and not yet given back.
+	void	taken(const Area *ap);
+
+	/// The number of areas in use
+	int		count() const	{ return int(used.size()); }
+
+private:
+
+	typedef	std::map<int,int>	UsedMap;	// base -> size
+
+	UsedMap	used;	///< the areas in use, ordered by address
+	int		size;	///< the size of the memory
+};
+
+#endif	/*AreaChecker_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,73 @@
+/** @file AreaIndex.cc
+ * De implementatie van AreaIndex.
+ */
+
+#include "AreaIndex.h"
+
+
+// Forget all tags
+void	AreaIndex::reset(int size, ALiterator none)
+{
+	require(size > 0);
+	this->none = none;
+	heads.assign(size, none);
+	tails.assign(size, none);
+}
+
+// Tag both ends of a free area
+void	AreaIndex::add(ALiterator i)
+{
+	Area  *ap = *i;
+	heads[ap->getBase()] = i;
+	tails[ap->getLast()] = i;
+}
+
+// Remove the tags of a free area
+void	AreaIndex::remove(const Area *ap)
+{
+	heads[ap->getBase()] = none;
+	tails[ap->getLast()] = none;
+}
+
+// Return an area to the resource map, merging it with its neighbours
+int		AreaIndex::insert(AreaList& areas, Area *ap, ALiterator& cursor)
+{
+	require(ap != 0);
+	int  merged = 0;
+	ALiterator  where = none;		// where 'ap' ends up in the list
+
+	// Is the area just below 'ap' free ?
+	ALiterator  i = before(ap);
+	if (i != none) {
+		Area  *bp = *i;
+		remove(bp);					// its "last" tag is about to change
+		bp->join(ap);				// append area ap to bp (and destroy ap)
+		ap = bp;					// now pretend this is the free'd area
+		where = i;					// which keeps its place in the list
+		++merged;
+	}
+
+	// Is the area just above 'ap' free ?
+	i = after(ap);
+	if (i != none) {
+		Area  *bp = *i;
+		remove(bp);
+		bool  atCursor = (cursor == i);		// NB 'erase' would invalidate 'cursor'
+		ALiterator  next = areas.erase(i);	// remove bp from the list
+		if (atCursor)
+			cursor = next;
+		ap->join(bp);						// append area bp to ap (and destroy bp)
+		if (where == none)					// ap takes the place of bp
+			where = areas.insert(next, ap);
+		++merged;
+	}
+
+	// No neighbours at all
+	if (where == none)
+		where = areas.insert(areas.end(), ap);
+
+	add(where);
+	return merged;
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,64 @@
+#pragma once
+#ifndef	__AreaIndex_h__
+#define	__AreaIndex_h__	1.0
+
+/** @file AreaIndex.h
+ *  @brief Boundary tags for the free areas in an AreaList.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include "main.h"		// for: AreaList, ALiterator
+
+
+/// @class AreaIndex
+/// Boundary tags voor een resource map.
+/// Voor elk vrij gebied wordt zowel bij het eerste als bij het laatste
+/// adres bijgehouden waar het in de AreaList staat. De buren van een
+/// teruggegeven gebied zijn dan in O(1) te vinden: het gebied dat eindigt
+/// op base-1 en het gebied dat begint op last+1.
+/// Het kost wel twee iterators per eenheid beheerd geheugen.
+class	AreaIndex
+{
+public:
+
+	/// Clear all tags for a memory of 'size' units.
+	/// @param size	the size of the memory
+	/// @param none	the iterator that means "no such area" (i.e. areas.end())
+	void	reset(int size, ALiterator none);
+
+	/// Tag both ends of the free area at 'i'
+	void	add(ALiterator i);
+
+	/// Remove the tags of free area 'ap'
+	void	remove(const Area *ap);
+
+	/// @returns	the free area that ends just before 'ap' (or 'none')
+	ALiterator	before(const Area *ap) const
+	{
+		return (ap->getBase() > 0) ? tails[ap->getBase() - 1] : none;
+	}
+
+	/// @returns	the free area that starts just after 'ap' (or 'none')
+	ALiterator	after(const Area *ap) const
+	{
+		return (ap->getLast() + 1 < int(heads.size())) ? heads[ap->getLast() + 1] : none;
+	}
+
+	/// Put free area 'ap' into 'areas' and merge it with its free neighbours.
+	/// A merged area keeps the list position of the neighbour it merged with,
+	/// an area without free neighbours is appended to the list.
+	/// @param areas	the resource map
+	/// @param ap		the area being returned to free space
+	/// @param cursor	an iterator into 'areas' that must stay valid (e.g. NextFit's cursor)
+	/// @returns		the number of merges done (0, 1 or 2)
+	int		insert(AreaList& areas, Area *ap, ALiterator& cursor);
+
+private:
+
+	std::vector<ALiterator>	heads;	///< heads[a] = the free area starting at address a
+	std::vector<ALiterator>	tails;	///< tails[a] = the free area ending at address a
+	ALiterator				none;	///< "no area here"
+};
+
+#endif	/*AreaIndex_h*/
+// vim:sw=4:ai:aw:ts=4:
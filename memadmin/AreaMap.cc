@@ -0,0 +1,146 @@
+/** @file AreaMap.cc
+ * De implementatie van AreaMap.
+ */
+
+#include <algorithm>	// for: std::upper_bound()
+
+#if defined(__AVX2__)
+# include <immintrin.h>	// AVX2 intrinsics
+#elif defined(__SSE2__)
+# include <emmintrin.h>	// SSE2 intrinsics
+#endif
+
+#include "asserts.h"	// for: require()
+#include "AreaMap.h"
+
+
+// Start with all memory free
+void	AreaMap::reset(int size)
+{
+	require(size > 0);
+	bases.assign(1, 0);
+	sizes.assign(1, size);
+}
+
+// Find the first area of at least 'wanted' units, starting at 'from'
+int		AreaMap::findFirst(int wanted, int from) const
+{
+	const int  n = count();
+	if (from >= n)
+		return -1;
+	const int  *sz = &sizes[0];
+	int  i = from;
+
+	// "size >= wanted" is the same as "size > wanted-1"
+#if defined(__AVX2__)
+	const __m256i  w8 = _mm256_set1_epi32(wanted - 1);
+	for ( ; i + 8 <= n ; i += 8) {			// 8 areas at a time
+		__m256i  v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sz + i));
+		int  m = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, w8)));
+		if (m)
+			return i + __builtin_ctz(m);
+	}
+#endif
+#if defined(__SSE2__)
+	const __m128i  w4 = _mm_set1_epi32(wanted - 1);
+	for ( ; i + 4 <= n ; i += 4) {			// 4 areas at a time
+		__m128i  v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sz + i));
+		int  m = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, w4)));
+		if (m)
+			return i + __builtin_ctz(m);
+	}
+#endif
+	for ( ; i < n ; ++i) {					// the scalar leftovers (or fallback)
+		if (sz[i] >= wanted)
+			return i;
+	}
+	return -1;
+}
+
+// Find the smallest area of at least 'wanted' units
+int		AreaMap::findBest(int wanted) const
+{
+	int  best = -1;
+	// Let findFirst skip over the runs of areas that are too small
+	for (int  i = findFirst(wanted) ; i >= 0 ; i = findFirst(wanted, i + 1)) {
+		if ((best < 0) || (sizes[i] < sizes[best])) {
+			best = i;
+			if (sizes[i] == wanted)			// can't do any better
+				break;
+		}
+	}
+	return best;
+}
+
+// Allocate from the front of free area 'i'
+Area	*AreaMap::take(int i, int wanted)
+{
+	require((0 <= i) && (i < count()));
+	require((0 < wanted) && (wanted <= sizes[i]));
+	Area  *ap = new Area(bases[i], wanted);
+	if (sizes[i] == wanted) {			// used completely
+		bases.erase(bases.begin() + i);
+		sizes.erase(sizes.begin() + i);
+	} else {							// keep the remainder
+		bases[i] += wanted;
+		sizes[i] -= wanted;
+	}
+	return ap;
+}
+
+// The first area with a base above 'addr'
+int		AreaMap::upper(int addr) const
+{
+	return int(std::upper_bound(bases.begin(), bases.end(), addr) - bases.begin());
+}
+
+// Find the first area that is not completely below 'addr'
+int		AreaMap::find(int addr) const
+{
+	int  i = upper(addr);
+	if ((i > 0) && (bases[i-1] + sizes[i-1] > addr))
+		return i - 1;				// 'addr' lies within this area
+	return i;
+}
+
+// Return an area, merging it with its neighbours
+int		AreaMap::insert(Area *ap)
+{
+	require(ap != 0);
+	int  base = ap->getBase();
+	int  size = ap->getSize();
+	delete ap;
+
+	int  i = upper(base);			// the area after 'ap' (if any)
+	bool  below = (i > 0) && (bases[i-1] + sizes[i-1] == base);
+	bool  above = (i < count()) && (base + size == bases[i]);
+
+	if (below && above) {			// fills the gap between two areas
+		sizes[i-1] += size + sizes[i];
+		bases.erase(bases.begin() + i);
+		sizes.erase(sizes.begin() + i);
+		return 2;
+	}
+	if (below) {					// extends the area before it
+		sizes[i-1] += size;
+		return 1;
+	}
+	if (above) {					// extends the area after it downwards
+		bases[i] = base;
+		sizes[i] += size;
+		return 1;
+	}
+	bases.insert(bases.begin() + i, base);
+	sizes.insert(sizes.begin() + i, size);
+	return 0;
+}
+
+// Check 'ap' against its would-be neighbours
+bool	AreaMap::overlaps(const Area *ap) const
+{
+	require(ap != 0);
+	int  i = upper(ap->getLast());	// all areas before 'i' start at or below ap's last address
+	return (i > 0) && (bases[i-1] + sizes[i-1] > ap->getBase());
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef	__AreaMap_h__
+#define	__AreaMap_h__	1.0
+
+/** @file AreaMap.h
+ *  @brief A resource map stored as parallel arrays of bases and sizes.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include "Area.h"		// class Area
+
+
+/// @class AreaMap
+/// Een resource map zonder losse Area objecten: de begin adressen en de
+/// omvang van de vrije gebieden staan in twee aaneengesloten arrays,
+/// gesorteerd op adres. Zoeken is dan geen pointer-jacht meer maar een
+/// lineaire scan door geheugen die (waar mogelijk) met SSE2/AVX2
+/// instructies 4 of 8 gebieden tegelijk vergelijkt.
+/// NB AVX2 wordt alleen gebruikt als de compiler het mag: "make SIMD=-mavx2".
+/// Omdat de map altijd op adres gesorteerd is worden teruggegeven
+/// gebieden meteen met hun buren samengevoegd.
+class	AreaMap
+{
+public:
+
+	/// Start with one free area of 'size' units.
+	void	reset(int size);
+
+	/// The number of free areas
+	int		count() const	{ return int(sizes.size()); }
+
+	int		getBase(int i) const	{ return bases[i]; }	///< start of free area 'i'
+	int		getSize(int i) const	{ return sizes[i]; }	///< size of free area 'i'
+
+	/// @returns	the index of the first area at or after 'from'
+	///				that has at least 'wanted' units, or -1
+	int		findFirst(int wanted, int from = 0) const;
+
+	/// @returns	the index of the smallest area with at least 'wanted'
+	///				units (the lowest address amongst equals), or -1
+	int		findBest(int wanted) const;
+
+	/// @returns	the index of the first area that ends at or after 'addr'
+	int		find(int addr) const;
+
+	/// Carve 'wanted' units from the front of free area 'i'.
+	/// @returns	a new Area descriptor for the allocated part
+	Area	*take(int i, int wanted);
+
+	/// Return an area to the map, merging it with its free neighbours.
+	/// The descriptor 'ap' is deleted.
+	/// @returns	the number of merges done (0, 1 or 2)
+	int		insert(Area *ap);
+
+	/// Does 'ap' overlap any of the free areas ? O(log n)
+	bool	overlaps(const Area *ap) const;
+
+private:
+
+	std::vector<int>	bases;	///< bases[i] = start address of free area i
+	std::vector<int>	sizes;	///< sizes[i] = size of free area i
+
+	/// @returns	the index of the first area with a base above 'addr'
+	int		upper(int addr) const;
+};
+
+#endif	/*AreaMap_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,131 @@
+/** @file ArrayFit.cc
+ * De implementatie van ArrayFit.
+ */
+
+#include "ArrayFit.h"
+#include "ansi.h"
+
+
+// The name of each policy
+static	const char	*names[] = {
+	"FirstFit (array)",
+	"NextFit (array)",
+	"BestFit (array)",
+};
+
+ArrayFit::ArrayFit(bool cflag, Policy policy)
+	: Fitter(cflag, names[policy]), policy(policy), cursor(0)
+{
+}
+
+// Initializes how much memory we own
+void  ArrayFit::setSize(int new_size)
+{
+	require(map.count() == 0);		// prevent changing the size when the map is nonempty
+	Fitter::setSize(new_size);
+	map.reset(new_size);			// and create the first free area (i.e. "all")
+	cursor = 0;
+}
+
+// Print the current free areas for debugging
+void	ArrayFit::dump()
+{
+	std::cerr << AC_BLUE << type << "::map";
+	for (int  i = 0 ; i < map.count() ; ++i) {
+		std::cerr << " Area(" << map.getBase(i) << "..."
+				  << (map.getBase(i) + map.getSize(i) - 1) << ':' << map.getSize(i) << ')';
+	}
+	std::cerr << AA_RESET << std::endl;
+}
+
+
+// Application wants 'wanted' memory
+Area  *ArrayFit::alloc(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	updateStats();				// update resource map statistics
+
+	if (map.count() == 0) {		// iff we have nothing
+		return 0;				// give up immediately
+	}
+
+	Area  *ap = searcher(wanted);
+	if (ap) {					// success ?
+		return ap;
+	}
+	reclaim();					// only for the statistics
+	// Alas, failed to allocate anything
+	//dump();//DEBUG
+	return 0;					// inform caller we failed
+}
+
+
+// Application returns an area no longer needed
+void	ArrayFit::free(Area *ap)
+{
+	require(ap != 0);
+	if (cflag) {
+		check(!map.overlaps(ap));	// the sanity check; only O(log n)
+	}
+	mergers += map.insert(ap);		// eager: merge with the neighbours (deletes ap)
+}
+
+// All areas in the map
+bool	ArrayFit::freeSpace(FreeSpace& fs)
+{
+	for (int i = 0 ; i < map.count() ; ++i)
+		fs.add(map.getSize(i));
+	return true;
+}
+
+
+// ----- internal utilities -----
+
+// Search for an area with at least 'wanted' memory
+Area  *ArrayFit::searcher(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	int  i = -1;
+	switch (policy) {
+	case FIRST:
+		i = map.findFirst(wanted);
+		break;
+	case NEXT:
+		i = map.findFirst(wanted, map.find(cursor));	// from the cursor to the end
+		if (i < 0)
+			i = map.findFirst(wanted);			// then wrap around
+		break;
+	case BEST:
+		i = map.findBest(wanted);
+		break;
+	}
+	if (i < 0) {
+		return 0;		// report failure
+	}
+	Area  *ap = map.take(i, wanted);
+	cursor = ap->getLast() + 1;		// NextFit continues after this area
+	return ap;
+}
+
+
+// The map is always kept merged
+bool	ArrayFit::reclaim()
+{
+	++reclaims;	// update statistics ("reclaims attempted")
+	return false;
+}
+
+// Update statistics
+void	ArrayFit::updateStats()
+{
+	long long  n = map.count();
+	++qcnt;					// number of 'alloc's
+	qsum  += n;				// length of resource map
+	qsum2 += (n * n);		// same: squared
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef	__ArrayFit_h__
+#define	__ArrayFit_h__	1.0
+
+/** @file ArrayFit.h
+ *  @brief The first, next and best fit algorithms on an array based resource map.
+ */
+
+#include "Fitter.h"
+#include "AreaMap.h"
+
+
+/// @class ArrayFit
+/// De FirstFit, NextFit en BestFit algoritmes, maar dan met een AreaMap
+/// (parallelle arrays met SIMD scans) als resource map i.p.v. een AreaList.
+/// Omdat de AreaMap altijd op adres gesorteerd is, is dit de eager versie.
+class	ArrayFit : public Fitter
+{
+public:
+
+	/// Welk gebied kiezen we ?
+	enum Policy {
+		FIRST,		///< the first area that is large enough
+		NEXT,		///< the first large enough area after the previous one
+		BEST		///< the smallest area that is large enough
+	};
+
+	/// @param cflag	initial status of check-mode
+	/// @param policy	which member of the fit family to be
+	ArrayFit(bool cflag, Policy policy);
+
+	void	 setSize(int new_size);	///< initialize memory size
+
+	/// Ask for an area of at least 'wanted' units.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// The application returns an area to freespace.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	bool	 freeSpace(FreeSpace& fs);	///< the free areas (see Allocator::freeSpace)
+
+protected:
+
+	AreaMap		map;		///< the free areas
+	Policy		policy;		///< how to choose an area
+	int			cursor;		///< NextFit: the address where the next search starts
+
+	/// For debugging this function shows the free areas
+	void	dump();
+
+	/// This is the actual function that searches for space.
+	/// @returns	An area or 0 if not enough freespace available
+	Area 	*searcher(int);
+
+	/// The map is always merged, so this has nothing to do.
+	/// @returns false
+	bool	 reclaim();
+
+	void	 updateStats();	///< update resource map statistics
+};
+
+#endif	/*ArrayFit_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,127 @@
+/** @file Backing.cc
+ * De implementatie van Backing.
+ */
+
+#include <cerrno>		// errno
+#include <cstring>		// strerror(3)
+#include <stdexcept>	// std::runtime_error
+#include <string>		// std::string
+#ifdef	unix
+# include <sys/mman.h>	// mmap(2), munmap(2)
+#endif
+#include "main.h"
+#include "Backing.h"
+#include "Histogram.h"	// nanotime()
+
+
+Backing::Backing(Allocator *inner, int unit)
+	: Wrapper(inner), unit(unit), memory(0), length(0)
+	, written(0), read(0), nanos(0), corrupt(0), pages(0)
+{
+	require(unit > 0);
+}
+
+Backing::~Backing()
+{
+	release();
+}
+
+// Initializes how much memory we own, and get it for real
+void	Backing::setSize(int new_size)
+{
+	Wrapper::setSize(new_size);
+	release();
+	length = (size_t)new_size * unit;
+#ifdef	unix
+	void  *p = mmap(0, length, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		throw std::runtime_error(std::string("Cannot mmap the memory: ") + strerror(errno));
+	memory = static_cast<char*>(p);
+#else
+	memory = new char[length];
+#endif
+	seen.assign(length / PAGE + 1, false);
+	written = read = nanos = corrupt = pages = 0;
+}
+
+
+// Application wants 'wanted' memory: and it will use it
+Area	*Backing::alloc(int wanted)
+{
+	Area  *ap = inner->alloc(wanted);
+	if (ap) {
+		long long  t0 = nanotime();
+		char  *p = address(ap);
+		char  *e = p + (size_t)ap->getSize() * unit;
+		char  c = pattern(ap);
+		for (char *q = p ; q < e ; q += LINE, ++written)
+			*q = c;
+		nanos += nanotime() - t0;
+		touch(p - memory, e - memory);
+	}
+	return ap;
+}
+
+// Application returns an area: read it one last time
+void	Backing::free(Area *ap)
+{
+	require(ap != 0);
+	long long  t0 = nanotime();
+	const char  *p = address(ap);
+	const char  *e = p + (size_t)ap->getSize() * unit;
+	char  c = pattern(ap);
+	bool  oke = true;
+	for (const char *q = p ; q < e ; q += LINE, ++read)
+		oke &= (*q == c);
+	nanos += nanotime() - t0;
+	if (!oke)
+		++corrupt;				// somebody else wrote here
+	inner->free(ap);
+}
+
+// Report statistics
+void	Backing::report()
+{
+	inner->report();
+	double  mb = double(written + read) * LINE / (1024 * 1024);
+	double  secs = nanos / 1e9;
+	std::cout << type << ": " << unit << " bytes per unit, "
+			  << written << " lines written, " << read << " lines read, "
+			  << mb << " MB in " << secs << " s";
+	if (secs > 0)
+		std::cout << " (" << (mb / 1024 / secs) << " GB/s)";
+	std::cout << '\n';
+	std::cout << type << ": " << pages << " of " << (length + PAGE - 1) / PAGE << " pages touched";
+	if (corrupt > 0)
+		std::cout << ", " << corrupt << " areas were overwritten by another";
+	std::cout << '\n';
+}
+
+
+// ----- internal utilities -----
+
+// Give the memory back to the system
+void	Backing::release()
+{
+	if (!memory)
+		return;
+#ifdef	unix
+	munmap(memory, length);
+#else
+	delete [] memory;
+#endif
+	memory = 0;
+}
+
+// Remember which pages were used
+void	Backing::touch(size_t from, size_t to)
+{
+	for (size_t pg = from / PAGE ; pg * PAGE < to ; ++pg) {
+		if (!seen[pg]) {
+			seen[pg] = true;
+			++pages;
+		}
+	}
+}
+
+// vim:sw=4:ai:aw:ts=4:
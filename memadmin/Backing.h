@@ -0,0 +1,75 @@
+#pragma once
+#ifndef	__Backing_h__
+#define	__Backing_h__	1.0
+
+/** @file Backing.h
+ *  @brief An Allocator wrapper that backs the areas with real memory.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include "Wrapper.h"
+
+
+/// @class Backing
+/// Geeft de eenheden van de inner allocator echt geheugen: bij setSize
+/// wordt een blok van size * unit bytes gereserveerd (met mmap) en
+/// eenheid n staat op byte n * unit. Elk gekregen gebied wordt meteen
+/// beschreven (een byte per cache line) en bij het vrijgeven weer
+/// gelezen en gecontroleerd. Zo kosten de plaatskeuzes van het algoritme
+/// echte cache misses en TLB misses, en het rapport laat de doorvoer
+/// en het aantal aangeraakte pagina's zien.
+/// Als bonus wordt zo ook een allocator betrapt die overlappende
+/// gebieden uitgeeft: dan klopt het gelezen patroon niet meer.
+class	Backing : public Wrapper
+{
+public:
+
+	/// @param inner	the allocator that does the real work (see Wrapper)
+	/// @param unit		the number of bytes per unit
+	Backing(Allocator *inner, int unit);
+
+	~Backing();		///< release the memory
+
+	void	 setSize(int new_size);	///< initialize memory size and get the memory
+
+	/// Ask for an area of 'wanted' units and write to it.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// Read the area and return it to the inner allocator.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	void	 report();		///< report the statistics and the throughput
+
+	/// The real address of an area
+	char	*address(const Area *ap) const	{ return memory + (size_t)ap->getBase() * unit; }
+
+private:
+
+	enum {
+		LINE = 64,			///< the size of a cache line
+		PAGE = 4096			///< the size of a page
+	};
+
+	int			unit;		///< bytes per unit
+	char		*memory;	///< the real memory
+	size_t		length;		///< its size in bytes
+
+	long long	written;	///< cache lines written
+	long long	read;		///< cache lines read
+	long long	nanos;		///< time spent in writing and reading
+	long long	corrupt;	///< areas that did not hold their pattern
+	std::vector<bool>	seen;	///< the pages ever touched
+	long long	pages;		///< how many
+
+	void	release();					///< give the memory back
+	void	touch(size_t from, size_t to);	///< count the pages in [from,to)
+
+	/// The byte written in all lines of an area
+	static	char	pattern(const Area *ap)
+	{ return char((unsigned(ap->getBase()) * 2654435761u) >> 24); }
+};
+
+#endif	/*Backing_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,115 @@
+/** @file Benchmark.cc
+ * De implementatie van Benchmark.
+ */
+
+#include "main.h"
+#include "Benchmark.h"
+#include "Factory.h"
+#include "Fitter.h"
+#include "FakeApplication.h"
+
+
+// The scenarios we know
+static	const char	*known[] = { "random", "servlets", "batches", 0 };
+
+bool	Benchmark::isScenario(const std::string& name)
+{
+	for (const char **k = known ; *k ; ++k) {
+		if (name == *k)
+			return true;
+	}
+	return false;
+}
+
+
+// Measure all registered allocators in all cells of the matrix
+void	Benchmark::run(std::ostream& out)
+{
+	require(repeat > 0);
+	if (scenarios.empty()) {		// default: all of them
+		for (const char **k = known ; *k ; ++k)
+			scenarios.push_back(*k);
+	}
+
+	if (json)
+		out << "[\n";
+	else
+		out << "allocator,type,scenario,size,actions,rep,seconds,ns_per_op,"
+			   "allocs,frees,oom,errors,reclaims,mergers,avg_areas,stdev_areas\n";
+
+	bool  first = true;
+	for (const AllocatorEntry *e = allocators ; e->name ; ++e) {
+		if (!e->bench)
+			continue;
+		for (size_t s = 0 ; s < sizes.size() ; ++s)
+		for (size_t c = 0 ; c < counts.size() ; ++c)
+		for (size_t k = 0 ; k < scenarios.size() ; ++k)
+		for (int r = 1 ; r <= repeat ; ++r) {
+			Allocator  *beheerder = e->make(false);
+			try {
+				beheerder->setSize(sizes[s]);
+				FakeApplication  app(beheerder, sizes[s]);
+				app.setQuiet(true);
+				if (scenarios[k] == "random")
+					app.randomscenario(counts[c], false);
+				else if (scenarios[k] == "batches")
+					app.batchScenario(counts[c], 8, false);
+				else
+					app.minderRandomScenario(counts[c], false);
+
+				// Collect the numbers
+				int  ops = app.getAllocs() + app.getFrees();
+				double  nsop = ops ? (app.getTime() * 1e9 / ops) : 0.0;
+				Fitter  *fp = dynamic_cast<Fitter*>(beheerder);
+				const char  *sep = json ? ", " : ",";
+				if (json) {
+					out << (first ? "  {" : ",\n  {")
+						<< "\"allocator\": \"" << e->name << "\", "
+						<< "\"type\": \"" << beheerder->getType() << "\", "
+						<< "\"scenario\": \"" << scenarios[k] << "\", "
+						<< "\"size\": " << sizes[s] << ", "
+						<< "\"actions\": " << counts[c] << ", "
+						<< "\"rep\": " << r << ", "
+						<< "\"seconds\": " << app.getTime() << ", "
+						<< "\"ns_per_op\": " << nsop << ", "
+						<< "\"allocs\": " << app.getAllocs() << ", "
+						<< "\"frees\": " << app.getFrees() << ", "
+						<< "\"oom\": " << app.getOOM() << ", "
+						<< "\"errors\": " << app.getErrors();
+					if (fp) {
+						out << sep << "\"reclaims\": " << fp->getReclaims()
+							<< sep << "\"mergers\": " << fp->getMergers()
+							<< sep << "\"avg_areas\": " << fp->getAverage()
+							<< sep << "\"stdev_areas\": " << fp->getStdev();
+					}
+					out << '}';
+				} else {
+					out << e->name << ",\"" << beheerder->getType() << "\","
+						<< scenarios[k] << ',' << sizes[s] << ',' << counts[c] << ',' << r << ','
+						<< app.getTime() << ',' << nsop << ','
+						<< app.getAllocs() << ',' << app.getFrees() << ','
+						<< app.getOOM() << ',' << app.getErrors() << ',';
+					if (fp) {
+						out << fp->getReclaims() << sep << fp->getMergers() << sep
+							<< fp->getAverage() << sep << fp->getStdev();
+					} else {
+						out << ",,,";	// not a Fitter: no resource map statistics
+					}
+					out << '\n';
+				}
+				first = false;
+			} catch (const std::logic_error& error) {
+				// e.g. a size this allocator can not handle
+				cerr << AC_RED << e->name << " at size " << sizes[s] << ": "
+					 << error.what() << AA_RESET << endl;
+			}
+			delete beheerder;
+		}
+	}
+
+	if (json)
+		out << "\n]\n";
+	out << std::flush;
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef	__Benchmark_h__
+#define	__Benchmark_h__	1.0
+
+/** @file Benchmark.h
+ *  @brief Runs all registered allocators on a matrix of sizes, counts and scenarios.
+ */
+
+#include <iostream>		// std::ostream
+#include <string>		// std::string
+#include <vector>		// the STL std::vector<> container
+
+
+/// @class Benchmark
+/// Meet alle geregistreerde allocators (zie Factory.h) in een keer.
+/// Voor elke combinatie van geheugen omvang, aantal acties en scenario
+/// wordt elke allocator 'repeat' keer gemeten, met een verse allocator
+/// en applicatie per meting. Per meting komt er een regel CSV of een
+/// JSON object uit zodat de resultaten van verschillende builds met
+/// een script vergeleken kunnen worden.
+class	Benchmark
+{
+public:
+
+	/// @param repeat	how often each cell is measured
+	/// @param json		JSON output i.s.o. CSV
+	Benchmark(int repeat, bool json) : repeat(repeat), json(json) {}
+
+	void	addSize(int size)				{ sizes.push_back(size); }		///< add a memory size
+	void	addCount(int aantal)			{ counts.push_back(aantal); }	///< add an action count
+	void	addScenario(const char *name)	{ scenarios.push_back(name); }	///< add a scenario
+
+	/// Is this the name of a scenario ?
+	static bool	isScenario(const std::string& name);
+
+	/// Measure everything and write the results to 'out'
+	void	run(std::ostream& out);
+
+private:
+
+	int		repeat;		///< measurements per cell
+	bool	json;		///< JSON output ?
+
+	std::vector<int>			sizes;		///< memory sizes
+	std::vector<int>			counts;		///< action counts
+	std::vector<std::string>	scenarios;	///< scenario names
+};
+
+#endif	/*Benchmark_h*/
+// vim:sw=4:ai:aw:ts=4:
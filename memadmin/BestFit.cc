@@ -2,6 +2,7 @@
  * De implementatie van BestFit.
  */
 
+#include <vector>		// std::vector
 #include "main.h"
 #include "BestFit.h"
 
@@ -43,13 +44,26 @@ Area  *BestFit::alloc(int wanted)
 
     updateStats();				// update resource map statistics
 
+    if (areas.empty())  		// iff we have nothing
+    {
+        return 0;				// give up immediately
+    }
+
     // Search thru all available free areas
     Area  *ap = 0;
 
     ap = searcher(wanted);		// first attempt
     if (ap)  					// success ?
     {
-        return ap;
+        return given(ap);
+    }
+    if (reclaim())  			// could we reclaim fragmented freespace ?
+    {
+        ap = searcher(wanted);	// then make a second attempt
+        if (ap)  				// success ?
+        {
+            return given(ap);
+        }
     }
 
     // Alas, failed to allocate anything
@@ -61,17 +75,35 @@ Area  *BestFit::alloc(int wanted)
 void	BestFit::free(Area *ap)
 {
     require(ap != 0);
+    taken(ap);				// sanity check (in check mode only)
+    areas.push_back(ap);	// de lazy version
+    if (tailStart == areas.end())
+        --tailStart;		// it starts the unsorted tail
+}
 
-    if (cflag)
+// Application wants several areas at once
+int		BestFit::allocBatch(const int *sizes, int n, Area **out)
+{
+    require(n >= 0);
+    for (int k = 0 ; k < n ; ++k)
     {
+        require(sizes[k] > 0);		// minstens "iets",
+        require(sizes[k] <= size);	// maar niet meer dan we kunnen hebben.
+        out[k] = 0;
+    }
 
-        // EXPENSIVE: check for overlap with already registered free areas
-        for (ALiterator  i = areas.begin() ; i != areas.end() ; ++i)
-        {
-            check(!ap->overlaps(*i));    // sanity check
-        }
+    updateStats();					// one search of the resource map
+
+    int  got = batchSearcher(sizes, n, out);	// first attempt
+    if ((got < n) && reclaim())  				// could we reclaim fragmented freespace ?
+    {
+        got += batchSearcher(sizes, n, out);	// then make a second attempt for the rest
     }
-    areas.push_back(ap);	// de lazy version
+    for (int k = 0 ; k < n ; ++k)
+    {
+        given(out[k]);
+    }
+    return got;
 }
 
 // ----- hulpfuncties -----
@@ -84,10 +116,12 @@ Area  *BestFit::searcher(int wanted)
 
     ALiterator  j = areas.end();    // where did we find the
     Area *currentBest = 0;          // best candidate
+    int probes = 0;                 // statistics: areas looked at
 
     for(ALiterator  i = areas.begin() ; i != areas.end() ; ++i)
     {
         Area  *ap = *i;
+        ++probes;
         if((ap->getSize() >= wanted)
            && (!currentBest || (ap->getSize() < currentBest->getSize())))
         {
@@ -95,48 +129,116 @@ Area  *BestFit::searcher(int wanted)
             j = i;
         }
     }
+    searchProbes.add(probes);
     if (!currentBest)
         return 0;
 
+    bool atTail = (j == tailStart); // NB 'erase' would invalidate 'tailStart'
     ALiterator next = areas.erase(j);
     if(currentBest->getSize() > wanted)
     {
         Area *rp = currentBest->split(wanted);
-        areas.insert(next, rp);
+        next = areas.insert(next, rp);
     }
+    if (atTail)
+        tailStart = next;           // the remainder keeps its place
 
     return currentBest;
 }
 
-// Try to join fragmented freespace
-bool	BestFit::reclaim()
+// Search for several areas with one pass.
+// The pass finds the best area for every open request, then they are
+// served in their order. An area keeps its place when a request takes
+// the front of it, so the other candidates stay valid; the remainder
+// becomes a candidate for the later requests when it is better.
+// Only when the area a request counted on is used up or too small
+// now, that request searches again on its own.
+// (With two equally good areas the choice may differ from 'searcher'.)
+int		BestFit::batchSearcher(const int *sizes, int n, Area **out)
 {
-    bool  changed = false;	// did we change anything ?
+    std::vector<ALiterator>  best(n, areas.end());	// the best candidate per request
+    std::vector<bool>  lost(n, false);				// that candidate was taken by another
+    int probes = 0;                 // statistics: areas looked at
 
-    // Sort resource map by area address
-    areas.sort( Area::orderByAddress() );	// WARNING: expensive N*log(N) operation !
+    for (ALiterator  i = areas.begin() ; i != areas.end() ; ++i)
+    {
+        Area  *ap = *i;
+        ++probes;
+        for (int k = 0 ; k < n ; ++k)
+        {
+            if (!out[k] && (ap->getSize() >= sizes[k])
+               && ((best[k] == areas.end()) || (ap->getSize() < (*best[k])->getSize())))
+            {
+                best[k] = i;
+            }
+        }
+    }
 
-    // Search thru all available areas for matches
-    ALiterator  i = areas.begin();
-    Area  *ap = *i;				// the current candidate ...
-    for (++i ; i != areas.end() ;)
+    int  got = 0;
+    for (int k = 0 ; k < n ; ++k)
     {
-        Area  *bp = *i;			// ... match ap with ...
-        if (bp->getBase() == (ap->getBase() + ap->getSize()))
+        if (out[k])
+            continue;
+        if (lost[k])                // then search again for this one
+        {
+            best[k] = areas.end();
+            for (ALiterator  i = areas.begin() ; i != areas.end() ; ++i)
+            {
+                ++probes;
+                if (((*i)->getSize() >= sizes[k])
+                   && ((best[k] == areas.end()) || ((*i)->getSize() < (*best[k])->getSize())))
+                {
+                    best[k] = i;
+                }
+            }
+        }
+        ALiterator  j = best[k];
+        if (j == areas.end())       // nothing fits (the areas only get smaller)
+            continue;
+
+        Area  *ap = *j;
+        if (ap->getSize() > sizes[k])
         {
-            // oke, bp matches ap ...
-            ALiterator  next = areas.erase(i);	// remove bp from the list
-            ap->join(bp);			// append area bp to ap (and destroy bp)
-            ++mergers;				// update statistics
-            changed = true;			// yes we changed something
-            i = next;				// revive the 'i' iterator
+            Area  *rp = ap->split(sizes[k]);
+            *j = rp;                // the remainder takes its place
+            for (int m = k + 1 ; m < n ; ++m)
+            {
+                if (out[m] || lost[m])
+                    continue;
+                if (best[m] == j)
+                    lost[m] = (rp->getSize() < sizes[m]);
+                else if ((rp->getSize() >= sizes[m])
+                         && ((best[m] == areas.end()) || (rp->getSize() < (*best[m])->getSize())))
+                    best[m] = j;
+            }
         }
         else
         {
-            ap = bp;				// move on to next area
-            ++i;
+            for (int m = k + 1 ; m < n ; ++m)
+            {
+                if (best[m] == j)
+                    lost[m] = true;
+            }
+            bool atTail = (j == tailStart); // NB 'erase' would invalidate 'tailStart'
+            ALiterator next = areas.erase(j);
+            if (atTail)
+                tailStart = next;
         }
+        out[k] = ap;
+        ++got;
     }
+    searchProbes.add(probes);
+    return got;
+}
+
+// Try to join fragmented freespace
+bool	BestFit::reclaim()
+{
+    bool  changed = false;	// did we change anything ?
+
+    // Only the areas free'd since the last time need sorting,
+    // then merge and join them with the rest in one linear pass
+    changed = coalesce(areas, tailStart);
     if (changed)  					// iff we have changed some area's the
     {
         cursor = areas.begin();		// next search should start at the (new) front
@@ -7,7 +7,7 @@ class BestFit : public Fitter
 {
     public:
         BestFit(bool cflag, const char *type = "BestFit (lazy)")
-        : Fitter(cflag, type), cursor(areas.begin()) {}
+        : Fitter(cflag, type), cursor(areas.begin()), tailStart(areas.end()) {}
 
         ~BestFit();
 
@@ -21,17 +21,32 @@ class BestFit : public Fitter
         /// @param ap	The area returned to free space
         virtual  void	free(Area *ap);
 
+        /// Ask for several areas, searching the resource map only once.
+        /// @returns	how many areas were given (a failed one is 0 in 'out')
+        virtual  int	allocBatch(const int *sizes, int n, Area **out);
+
+        /// Describe the resource map (see Allocator::freeSpace)
+        bool	 freeSpace(FreeSpace& fs)	{ countFree(areas, fs); return true; }
+
     protected:
 
         /// List of all the available free areas
-        std::list<Area*>  areas;
+        AreaList  areas;
 
         /// For debugging this function shows the free area list
         virtual	 void	dump();
 
         ALiterator	  cursor;		///< remembers where we stopped searching last time
 
+        /// The areas before this one are sorted by address,
+        /// from here on they were free'd since the last reclaim.
+        ALiterator	  tailStart;
+
         Area 	*searcher(int);
+
+        /// Serve all requests in 'out' that are still 0 with one pass over the resource map.
+        /// @returns	how many of them could be served
+        int		 batchSearcher(const int *sizes, int n, Area **out);
         virtual	 bool	  reclaim();
 
         virtual  void	updateStats();	///< update resource map statistics
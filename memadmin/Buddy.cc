@@ -0,0 +1,189 @@
+/** @file Buddy.cc
+ * De implementatie van Buddy.
+ */
+
+#include "Buddy.h"
+#include "ansi.h"
+
+
+Buddy::Buddy(bool cflag, const char *type)
+	: Fitter(cflag, type), nonempty(0), count(0)
+	, wasted(0), peakWaste(0), wasteSum(0), granted(0)
+{
+	for (int k = 0 ; k < MAXORDER ; ++k)
+		heads[k] = -1;
+}
+
+// Initializes how much memory we own
+void  Buddy::setSize(int new_size)
+{
+	require(count == 0);				// prevent changing the size when the free-lists are nonempty
+	Fitter::setSize(new_size);
+	orders.assign(new_size, -1);
+	next.assign(new_size, -1);
+	prev.assign(new_size, -1);
+	wasted = peakWaste = wasteSum = granted = 0;
+
+	// Cut the memory in the largest aligned blocks possible:
+	// one block for every bit that is set in 'new_size'.
+	int  base = 0;
+	for (int k = MAXORDER - 1 ; k >= 0 ; --k) {
+		if (new_size & (1 << k)) {
+			push(base, k);
+			base += (1 << k);
+		}
+	}
+}
+
+// Print the free-lists for debugging
+void	Buddy::dump()
+{
+	std::cerr << AC_BLUE << type << "::free";
+	for (int k = 0 ; k < MAXORDER ; ++k) {
+		if (heads[k] < 0)
+			continue;
+		std::cerr << " [" << k << "]";
+		for (int b = heads[k] ; b >= 0 ; b = next[b]) {
+			std::cerr << ' ' << b;
+		}
+	}
+	std::cerr << AA_RESET << std::endl;
+}
+
+
+// Application wants 'wanted' memory
+Area  *Buddy::alloc(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	updateStats();				// update resource map statistics
+
+	Area  *ap = searcher(wanted);
+	if (ap) {					// success ?
+		return given(ap);
+	}
+	reclaim();					// only for the statistics
+	return 0;					// inform caller we failed
+}
+
+
+// Application returns an area no longer needed
+void	Buddy::free(Area *ap)
+{
+	require(ap != 0);
+	taken(ap);					// the sanity check (in check mode only)
+	int  b = ap->getBase();
+	int  k = orderOf(ap->getSize());
+	wasted  -= (1 << k) - ap->getSize();
+	granted -= (1 << k);
+	delete ap;
+
+	// Merge with the buddy as long as that one is free too
+	while (k < MAXORDER - 1) {
+		int  buddy = b ^ (1 << k);
+		if ((buddy + (1 << k) > size) || (orders[buddy] != k))
+			break;						// no (whole) buddy, or it is in use/split
+		unlink(buddy, k);
+		++mergers;						// update statistics
+		b &= ~(1 << k);					// the combined block starts at the lower one
+		++k;
+	}
+	push(b, k);
+}
+
+// Report statistics
+void	Buddy::report()
+{
+	Fitter::report();
+	std::cout << type << ": internal fragmentation " << wasted << " units now, "
+			  << peakWaste << " units at most, "
+			  << (qcnt ? double(wasteSum) / qcnt : 0.0) << " units on average\n";
+	std::cout << type << ": " << granted << " units handed out, of which "
+			  << (granted ? (100.0 * wasted / granted) : 0.0) << "% wasted\n";
+}
+
+// The free blocks; what an allocated block lost to rounding up is not free
+bool	Buddy::freeSpace(FreeSpace& fs)
+{
+	for (int k = 0 ; k < MAXORDER ; ++k) {
+		for (int b = heads[k] ; b >= 0 ; b = next[b])
+			fs.add(1 << k);
+	}
+	return true;
+}
+
+
+// ----- internal utilities -----
+
+// Put block b on the order k free-list
+void	Buddy::push(int b, int k)
+{
+	orders[b] = k;
+	prev[b] = -1;
+	next[b] = heads[k];
+	if (heads[k] >= 0)
+		prev[heads[k]] = b;
+	heads[k] = b;
+	nonempty |= (1u << k);
+	++count;
+}
+
+// Remove block b from the order k free-list
+void	Buddy::unlink(int b, int k)
+{
+	if (prev[b] >= 0)
+		next[prev[b]] = next[b];
+	else
+		heads[k] = next[b];
+	if (next[b] >= 0)
+		prev[next[b]] = prev[b];
+	if (heads[k] < 0)
+		nonempty &= ~(1u << k);
+	orders[b] = -1;
+	--count;
+}
+
+// Find a block for 'wanted' units, splitting larger blocks as needed
+Area  *Buddy::searcher(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	int  k = orderOf(wanted);
+	unsigned  avail = nonempty & ~((1u << k) - 1);	// orders that are large enough
+	if (avail == 0) {
+		return 0;				// report failure
+	}
+	int  j = __builtin_ctz(avail);	// the smallest one of those
+	int  b = heads[j];
+	unlink(b, j);
+	while (j > k) {				// split, keep the lower half
+		--j;
+		push(b + (1 << j), j);	// and the upper half becomes free
+	}
+
+	wasted  += (1 << k) - wanted;
+	granted += (1 << k);
+	wasteSum += wasted;
+	if (wasted > peakWaste)
+		peakWaste = wasted;
+	return new Area(b, wanted);
+}
+
+// Buddies are always merged immediately
+bool	Buddy::reclaim()
+{
+	++reclaims;	// update statistics ("reclaims attempted")
+	return false;
+}
+
+// Update statistics
+void	Buddy::updateStats()
+{
+	++qcnt;									// number of 'alloc's
+	qsum  += count;							// number of free blocks
+	qsum2 += ((long long)count * count);	// same: squared
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef	__Buddy_h__
+#define	__Buddy_h__	1.0
+
+/** @file Buddy.h
+ *  @brief The class that implements the binary buddy algorithm.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include "Fitter.h"
+
+
+/// @class Buddy
+/// Het binary buddy algoritme.
+/// Het geheugen wordt verdeeld in blokken van 2^k eenheden die altijd
+/// op een veelvoud van hun eigen omvang beginnen. Voor elke "order" k is
+/// er een free-list; een aanvraag wordt naar boven afgerond op een macht
+/// van twee en zonodig wordt een groter blok steeds gehalveerd.
+/// De "buddy" van blok b van order k is blok b^(2^k): bij een free wordt
+/// in de order-map in O(1) gekeken of die ook vrij is, zo ja dan worden ze
+/// weer samengevoegd (en zo verder omhoog).
+/// Het afronden kost interne fragmentatie; die wordt apart bijgehouden.
+/// NB Als de omvang van het geheugen geen macht van twee is, wordt het
+/// opgedeeld in meerdere "top" blokken en kan dus niet alles in een keer
+/// uitgegeven worden (gebruik b.v. -s 8192 i.p.v. de default 10240).
+class	Buddy : public Fitter
+{
+public:
+
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	/// @param cflag	initial status of check-mode
+	/// @param type		name of this algorithm (default=Buddy)
+	Buddy(bool cflag, const char *type = "Buddy");
+
+	void	 setSize(int new_size);	///< initialize memory size
+
+	/// Ask for an area of at least 'wanted' units.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// The application returns an area to freespace.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	bool	 freeSpace(FreeSpace& fs);	///< the free areas (see Allocator::freeSpace)
+
+	void	 report();			///< report statistics, including the waste
+
+protected:
+
+	enum { MAXORDER = 31 };		///< the largest block is 2^30 units
+
+	std::vector<signed char>	orders;	///< orders[b] = order of the free block at b, or -1
+	std::vector<int>	next;	///< the free-lists: next[b] = next free block of the same order
+	std::vector<int>	prev;	///< and prev[b] the previous one (or -1)
+	int			heads[MAXORDER];	///< the first free block of each order (or -1)
+	unsigned	nonempty;		///< bit k is set iff the order k free-list is not empty
+	int			count;			///< the number of free blocks
+
+	// Counters for the internal fragmentation
+	long long	wasted;		///< units currently lost to rounding up
+	long long	peakWaste;	///< the highest value of 'wasted'
+	long long	wasteSum;	///< sum of 'wasted' at each alloc (for the average)
+	long long	granted;	///< units currently handed out (incl. waste)
+
+	/// The order of the smallest block that holds 'n' units
+	static int	orderOf(int n)	{ return (n <= 1) ? 0 : 32 - __builtin_clz(unsigned(n - 1)); }
+
+	void	push(int b, int k);		///< put block b on the order k free-list
+	void	unlink(int b, int k);	///< remove block b from the order k free-list
+
+	/// For debugging this function shows the free-lists
+	void	dump();
+
+	/// This is the actual function that searches for space.
+	/// @returns	An area or 0 if not enough freespace available
+	Area 	*searcher(int);
+
+	/// Buddies are merged as soon as they are free'd.
+	/// @returns false
+	bool	 reclaim();
+
+	void	 updateStats();	///< update resource map statistics
+};
+
+#endif	/*Buddy_h*/
+// vim:sw=4:ai:aw:ts=4:
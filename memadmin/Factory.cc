@@ -0,0 +1,107 @@
+/** @file Factory.cc
+ * De implementatie van de allocator registry.
+ */
+
+#include <cstring>		// strcmp(3)
+#include "main.h"
+#include "Factory.h"
+
+#include "RandomFit.h"
+#include "FirstFit.h"
+#include "FirstFit2.h"
+#include "NextFit.h"
+#include "NextFit2.h"
+#include "BestFit.h"
+#include "WorstFit.h"
+#include "WorstFit2.h"
+#include "SegregatedFit.h"
+#include "TreeBestFit.h"
+#include "ArrayFit.h"
+#include "McKusickK.h"
+#include "Buddy.h"
+#include "TLSF.h"
+#include "PolicyFitter.h"
+
+
+// The constructors, as plain functions
+static	Allocator	*makeRandomFit(bool c)		{ return new RandomFit(c); }
+static	Allocator	*makeFirstFit(bool c)		{ return new FirstFit(c); }
+static	Allocator	*makeFirstFit2(bool c)		{ return new FirstFit2(c, false); }
+static	Allocator	*makeFirstFit2i(bool c)		{ return new FirstFit2(c, true); }
+static	Allocator	*makeNextFit(bool c)		{ return new NextFit(c); }
+static	Allocator	*makeNextFit2(bool c)		{ return new NextFit2(c, false); }
+static	Allocator	*makeNextFit2i(bool c)		{ return new NextFit2(c, true); }
+static	Allocator	*makeBestFit(bool c)		{ return new BestFit(c); }
+static	Allocator	*makeWorstFit(bool c)		{ return new WorstFit(c); }
+static	Allocator	*makeWorstFit2(bool c)		{ return new WorstFit2(c); }
+static	Allocator	*makeSegregatedFit(bool c)	{ return new SegregatedFit(c); }
+static	Allocator	*makeTreeBestFit(bool c)	{ return new TreeBestFit(c); }
+static	Allocator	*makeArrayFirst(bool c)		{ return new ArrayFit(c, ArrayFit::FIRST); }
+static	Allocator	*makeArrayNext(bool c)		{ return new ArrayFit(c, ArrayFit::NEXT); }
+static	Allocator	*makeArrayBest(bool c)		{ return new ArrayFit(c, ArrayFit::BEST); }
+static	Allocator	*makeMcKusickK(bool c)		{ return new McKusickK(c); }
+static	Allocator	*makeBuddy(bool c)			{ return new Buddy(c); }
+static	Allocator	*makeTLSF(bool c)			{ return new TLSF(c); }
+
+// The template versions of the list based fitters (see PolicyFitter.h)
+template<class Search, class Merge>
+static	Allocator	*makePolicy(bool c)			{ return new PolicyFitter<Search, Merge>(c); }
+
+const AllocatorEntry	allocators[] = {
+	{ "r",	false,	makeRandomFit },		// a dummy, not worth measuring
+	{ "f",	true,	makeFirstFit },
+	{ "F",	true,	makeFirstFit2 },
+	{ "iF",	true,	makeFirstFit2i },
+	{ "n",	true,	makeNextFit },
+	{ "N",	true,	makeNextFit2 },
+	{ "iN",	true,	makeNextFit2i },
+	{ "b",	true,	makeBestFit },
+	{ "w",	true,	makeWorstFit },
+	{ "W",	true,	makeWorstFit2 },
+	{ "g",	true,	makeSegregatedFit },
+	{ "T",	true,	makeTreeBestFit },
+	{ "Af",	true,	makeArrayFirst },
+	{ "An",	true,	makeArrayNext },
+	{ "Ab",	true,	makeArrayBest },
+	{ "m",	true,	makeMcKusickK },
+	{ "2",	true,	makeBuddy },
+	{ "l",	true,	makeTLSF },
+	{ "Yf",	true,	makePolicy<FirstSearch, LazyMerge> },
+	{ "YF",	true,	makePolicy<FirstSearch, EagerMerge> },
+	{ "YiF",true,	makePolicy<FirstSearch, IndexedMerge> },
+	{ "Yn",	true,	makePolicy<NextSearch, LazyMerge> },
+	{ "YN",	true,	makePolicy<NextSearch, UnsortedMerge> },
+	{ "YiN",true,	makePolicy<NextSearch, IndexedMerge> },
+	{ "Yb",	true,	makePolicy<BestSearch, LazyMerge> },
+	{ "B",	true,	makePolicy<BestSearch, EagerMerge> },	// only as a template
+	{ "iB",	true,	makePolicy<BestSearch, IndexedMerge> },
+	{ 0,	false,	0 }
+};
+
+
+// Create an allocator by name
+Allocator	*makeAllocator(const char *name, bool cflag)
+{
+	require(name != 0);
+	for (const AllocatorEntry *e = allocators ; e->name ; ++e) {
+		if (strcmp(e->name, name) == 0)
+			return e->make(cflag);
+	}
+	return 0;
+}
+
+// Find an allocator by the name of its algorithm
+const AllocatorEntry	*findAllocator(const char *type)
+{
+	require(type != 0);
+	for (const AllocatorEntry *e = allocators ; e->name ; ++e) {
+		Allocator  *ap = e->make(false);
+		bool  same = (strcmp(ap->getType(), type) == 0);
+		delete ap;
+		if (same)
+			return e;
+	}
+	return 0;
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,35 @@
+#pragma once
+#ifndef	__Factory_h__
+#define	__Factory_h__	1.0
+
+/** @file Factory.h
+ *  @brief The registry of all allocators, by the name of their option.
+ */
+
+#include "Allocator.h"
+
+
+/// One registered allocator
+struct	AllocatorEntry {
+	const char	*name;		///< the option that selects it, e.g. "F" or "Ab"
+	bool		 bench;		///< take part in a benchmark (-M) ?
+	Allocator	*(*make)(bool cflag);	///< create one
+};
+
+/// All registered allocators, ended by an entry with name 0.
+/// NB When you add an algorithm, add it here too.
+extern	const AllocatorEntry	allocators[];
+
+/// Create the allocator that is registered under 'name'.
+/// @param name		the option letter(s), e.g. "f", "iF" or "An"
+/// @param cflag	initial status of check-mode
+/// @returns		the allocator, or 0 if the name is unknown
+Allocator	*makeAllocator(const char *name, bool cflag);
+
+/// Find the registration of an algorithm by its type name.
+/// @param type		the name of the algorithm, see Allocator::getType()
+/// @returns		its entry, or 0 if it is not registered
+const AllocatorEntry	*findAllocator(const char *type);
+
+#endif	/*Factory_h*/
+// vim:sw=4:ai:aw:ts=4:
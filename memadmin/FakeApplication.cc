@@ -10,6 +10,7 @@
 #include "main.h"			// common global stuff
 #include "Stopwatch.h"		// De cpu tijd meter
 #include "FakeApplication.h"	// De pseudo applicatie
+#include "Workload.h"		// Instelbare werklasten
 
 // introduce std shorthands
 using std::cout;
@@ -41,8 +42,8 @@ bool	vraagkans(int r)
 // hebben over 'size' eenheden geheugen.
 FakeApplication::FakeApplication(Allocator *beheerder, int size)
     : beheerder(beheerder), size(size)
-    , vflag(false), tflag(true)
-    , err_teller(0), oom_teller(0)
+    , vflag(false), tflag(true), qflag(false)
+    , err_teller(0), oom_teller(0), alloc_teller(0), free_teller(0), elapsed(0)
 {
     // nooit iets geloven ...
     require(beheerder != 0);
@@ -63,7 +64,7 @@ FakeApplication::~FakeApplication()
 
 
 // actie: vraag om geheugen (onze versie van 'new')
-void	FakeApplication::vraagGeheugen(int omvang)
+Area	*FakeApplication::vraagGeheugen(int omvang)
 {
     if (vflag)
     {
@@ -77,7 +78,7 @@ void	FakeApplication::vraagGeheugen(int omvang)
     }
 
     // Vraag om geheugen
-    // Vraag om geheugen
+    ++alloc_teller;
     Area  *ap = beheerder->alloc(omvang);
 
     if (ap == 0)    // Allocator out of memory?
@@ -87,7 +88,7 @@ void	FakeApplication::vraagGeheugen(int omvang)
             cout << AC_RED"out of memory"AA_RESET << endl;
         }
         ++oom_teller;	// out-of-memory teller bijwerken
-        return;
+        return 0;
     }
     if (vflag)
     {
@@ -96,27 +97,22 @@ void	FakeApplication::vraagGeheugen(int omvang)
 
     // Nu moeten we eerst controlen of er geen overlap
     // bestaat met wat we al eerder hadden gekregen ...
-    ALiterator  i;
-    for (i = objecten.begin() ; i != objecten.end() ; ++i)
+    Area  *xp = overlapt(ap);
+    if (xp)							// Oeps!
     {
-        Area  *xp = *i;				// m.a.w. objecten[ i ]
-        if (ap->overlaps(xp))       // Oeps!
+        // Dit zou eigenlijk een "fatal error" moeten zijn,
+        // maar bij de RandomFit zal dit wel vaker gebeuren
+        // dus voorlopig alleen maar melden dat het fout is ...
+        if (vflag)
         {
-            // Dit zou eigenlijk een "fatal error" moeten zijn,
-            // maar bij de RandomFit zal dit wel vaker gebeuren
-            // dus voorlopig alleen maar melden dat het fout is ...
-            if (vflag)
-            {
-                cout << AC_RED"Oeps, het nieuwe gebied overlapt met " << (*xp) << AA_RESET << endl;
-            }
-            ++err_teller;	// fouten teller bijwerken
-            break;			// verder zoeken is niet meer zo zinvol ...
-            // ... en levert alleen maar meer uitvoer op.
+            cout << AC_RED"Oeps, het nieuwe gebied overlapt met " << (*xp) << AA_RESET << endl;
         }
+        ++err_teller;	// fouten teller bijwerken
     }
 
     // Het gekregen gebied moeten we natuurlijk wel onthouden.
-    objecten.push_back(ap);
+    onthoud(ap);
+    return ap;
 }
 
 
@@ -124,17 +120,91 @@ void	FakeApplication::vraagGeheugen(int omvang)
 void	FakeApplication::vergeetOudste()
 {
     require(! objecten.empty());	// hebben we eigenlijk wel wat ?
-    Area  *ap = objecten.front();	// het oudste gebied opzoeken
+    // NB Door het weghalen met "de laatste op die plek" is dit
+    // alleen zolang er niets tussenuit gehaald is echt de oudste.
+    Area  *ap = verwijder(0);		// gebied uit de lijst halen
     if (vflag)
     {
         // vertel wat we gaan doen
         cout << "Vrijgeven " << (*ap) << endl;
     }
-    objecten.pop_front();			// gebied uit de lijst halen
+    ++free_teller;
     beheerder->free(ap);			// en vrij geven
 }
 
 
+// actie: geef dit gebied weer terug
+void	FakeApplication::vergeet(Area *ap)
+{
+    require(ap != 0);
+    std::multimap<int, size_t>::iterator  i = zoek(ap);
+    require(i != adressen.end());	// hebben we het eigenlijk wel ?
+    if (vflag)
+    {
+        // vertel wat we gaan doen
+        cout << "Vrijgeven " << (*ap) << endl;
+    }
+    verwijder(i->second);			// uit de lijst halen
+    ++free_teller;
+    beheerder->free(ap);			// en vrij geven
+}
+
+
+// Onthoud een gekregen gebied
+void	FakeApplication::onthoud(Area *ap)
+{
+    adressen.insert(std::make_pair(ap->getBase(), objecten.size()));
+    objecten.push_back(ap);
+}
+
+// Haal het object op 'plaats' weg: de laatste komt op die plek
+Area	*FakeApplication::verwijder(size_t plaats)
+{
+    require(plaats < objecten.size());
+    Area  *ap = objecten[plaats];
+    adressen.erase(zoek(ap));
+    size_t  laatste = objecten.size() - 1;
+    if (plaats != laatste)
+    {
+        objecten[plaats] = objecten[laatste];
+        zoek(objecten[plaats])->second = plaats;	// die is verhuisd
+    }
+    objecten.pop_back();
+    return ap;
+}
+
+// Zoek 'ap' in de adressen (NB er kunnen er meer op hetzelfde adres staan)
+std::multimap<int, size_t>::iterator	FakeApplication::zoek(Area *ap)
+{
+    std::pair<std::multimap<int, size_t>::iterator, std::multimap<int, size_t>::iterator>
+        r = adressen.equal_range(ap->getBase());
+    for (std::multimap<int, size_t>::iterator i = r.first ; i != r.second ; ++i)
+    {
+        if (objecten[i->second] == ap)
+            return i;
+    }
+    return adressen.end();
+}
+
+// Overlapt 'ap' met een van de objecten ?
+// Zolang de objecten elkaar niet overlappen hoeven alleen de buren
+// (op adres) bekeken te worden: de laatste die ervoor begint
+// en de eerste die erna (of op hetzelfde adres) begint.
+Area	*FakeApplication::overlapt(Area *ap)
+{
+    std::multimap<int, size_t>::iterator  i = adressen.lower_bound(ap->getBase());
+    if (i != adressen.end() && ap->overlaps(objecten[i->second]))
+        return objecten[i->second];
+    if (i != adressen.begin())
+    {
+        --i;
+        if (ap->overlaps(objecten[i->second]))
+            return objecten[i->second];
+    }
+    return 0;
+}
+
+
 // Utility:
 // Returns a random integer in the range
 // from min (inclusive) upto max (exclusive)
@@ -153,25 +223,9 @@ void	FakeApplication::vergeetRandom()
 {
     require(! objecten.empty());	// hebben we eigenlijk wel wat ?
 
-    Area  *ap = objecten.front();	// het oudste gebied alvast opzoeken
-
     int  n = objecten.size();		// valt er wat te kiezen?
-    if (n > 1)
-    {
-        int  m = randint(0, n);		// kies een index
-        // en zoek dat element op
-        ALiterator  i;
-        for (i = objecten.begin() ; (m > 0) && (i != objecten.end()) ; ++i, --m)
-        {
-            ;
-        }
-        ap = *i;					// het slachtoffer
-        objecten.erase(i);			// uit de lijst halen
-    }
-    else
-    {
-        objecten.pop_front();    // oudste gebied uit de lijst halen
-    }
+    int  m = (n > 1) ? randint(0, n) : 0;	// kies een index
+    Area  *ap = verwijder(m);		// het slachtoffer uit de lijst halen
 
     if (vflag)
     {
@@ -179,6 +233,7 @@ void	FakeApplication::vergeetRandom()
         cout << "Vrijgeven " << (*ap) << endl;
     }
 
+    ++free_teller;
     beheerder->free(ap);			// en het gebied weer vrij geven
 }
 
@@ -189,6 +244,8 @@ void FakeApplication::minderRandomScenario(int aantal, bool vflag)
 
     oom_teller = 0;			// reset failure counter
     err_teller = 0;			// reset error counter
+    alloc_teller = 0;		// reset alloc counter
+    free_teller = 0;		// reset free counter
 
     srand(1);   // (zie: man 3 rand)
 
@@ -205,41 +262,47 @@ void FakeApplication::minderRandomScenario(int aantal, bool vflag)
     int app4 = 0;
     int app5 = 0;
 
+    const int  N = sizeof(numbers) / sizeof(numbers[0]);	// NB het scenario herhaalt zich
     for (int  x = 0 ; x < aantal ; ++x)  	// Doe nu tig-keer "iets".
     {
-        int  r = numbers[x];
+        int  r = numbers[x % N];
 
         if (objecten.empty()				// Als we nog niets hebben of
                 || r > 7 )					// we kiezen voor ruimte aanvragen
         {
 
-           r = kiesServlet(numbers[x - 1]); // hulp methode die kiest welke servlet gebruikt wordt
+           r = kiesServlet(numbers[(x + N - 1) % N]); // hulp methode die kiest welke servlet gebruikt wordt
 
             switch (r)
             {
             case 1: // wachtwoord vergeten
                 vraagGeheugen(2);
-                cout << "wachtwoord vergeten (5)" << endl;
+                if (!qflag)
+                    cout << "wachtwoord vergeten (5)" << endl;
                 app1++;
                 break;
             case 2: // nieuwe klant registreren
                 vraagGeheugen(4);
-                cout << "wachtwoord vergeten (10)" << endl;
+                if (!qflag)
+                    cout << "wachtwoord vergeten (10)" << endl;
                 app2++;
                 break;
             case 3: // geld overmaken
                 vraagGeheugen(5);
-                cout << "geld overmaken" << endl;
+                if (!qflag)
+                    cout << "geld overmaken" << endl;
                 app3++;
                 break;
             case 4: // hypotheek afsluiten
                 vraagGeheugen(8);
-                cout << "hypotheek afsluiten" << endl;
+                if (!qflag)
+                    cout << "hypotheek afsluiten" << endl;
                 app4++;
                 break;
             case 5: // betaling via iDeal
                 vraagGeheugen(10);
-                cout << "betaling via iDeal" << endl;
+                if (!qflag)
+                    cout << "betaling via iDeal" << endl;
                 app5++;
                 break;
             }
@@ -249,7 +312,8 @@ void FakeApplication::minderRandomScenario(int aantal, bool vflag)
             if (!objecten.empty())  			// ... we iets hebben
             {
                 vergeetRandom();				// sluit een random servlet
-                cout << "random servlet afgesloten" << endl;
+                if (!qflag)
+                    cout << "random servlet afgesloten" << endl;
             }
             // else
             // dan doen we een keer niets
@@ -261,8 +325,16 @@ void FakeApplication::minderRandomScenario(int aantal, bool vflag)
         }
     }
     klok.stop();			// -----------------------------------	// -----------------------------------
+    elapsed = klok.gettotal();
+
+    if (qflag)  								// quiet: the caller reports
+    {
+        this->vflag = old_vflag;
+        return;
+    }
 
     klok.report();			// Vertel alle tijden
+    reportPerAlloc(klok);	// en de gemiddelde tijd per alloc
     beheerder->report();	// en de geheugenbeheer statistieken
 
     // Evaluatie
@@ -290,9 +362,180 @@ void FakeApplication::minderRandomScenario(int aantal, bool vflag)
 }
 
 
+// Een scenario volgens een instelbare werklast:
+// de werklast bepaalt wie er sterft en hoe groot het volgende object is.
+void	FakeApplication::workloadScenario(Workload& w, int aantal, bool vflag)
+{
+    bool old_vflag = this->vflag;
+    this->vflag = vflag;	// verbose mode aan/uit
+
+    oom_teller = 0;			// reset failure counter
+    err_teller = 0;			// reset error counter
+    alloc_teller = 0;		// reset alloc counter
+    free_teller = 0;		// reset free counter
+
+    w.restart();			// NB dezelfde seed geeft hetzelfde scenario
+
+    Stopwatch  klok;		// Een stopwatch om de tijd te meten
+    klok.start();			// -----------------------------------
+    for (int  x = 0 ; x < aantal ; ++x, w.tick())
+    {
+        Area  *ap = w.victim();				// Moet er iets dood ?
+        if (ap)
+        {
+            vergeet(ap);
+        }
+        else
+        {
+            int  omvang = w.nextSize();
+            if (omvang > size)
+                omvang = size;				// meer bestaat er niet
+            ap = vraagGeheugen(omvang);
+            if (ap)
+                w.born(ap);
+        }
+    }
+    klok.stop();			// -----------------------------------
+    elapsed = klok.gettotal();
+    w.restart();			// de werklast vergeet de overgebleven objecten
+
+    if (qflag)  								// quiet: the caller reports
+    {
+        this->vflag = old_vflag;
+        return;
+    }
+
+    w.report();				// Vertel wat voor werklast
+    klok.report();			// en alle tijden
+    reportPerAlloc(klok);	// en de gemiddelde tijd per alloc
+    beheerder->report();	// en de geheugenbeheer statistieken
+
+    // Evaluatie
+    if ((oom_teller > 0) || (err_teller > 0) )  	// some errors
+    {
+        cout << AC_RED "De allocater faalde " << oom_teller << " keer";
+        cout << " en maakte " << err_teller << " fouten\n" AA_RESET;
+    }
+    else  										// no problems
+    {
+        cout << AC_GREEN "De allocater faalde " << oom_teller << " keer";
+        cout << " en maakte " << err_teller << " fouten\n" AA_RESET;
+    }
+
+    this->vflag = old_vflag; // turn on verbose output again
+}
+
+
+// Een scenario met "requests" die elk een paar objecten tegelijk
+// aanvragen en die ook weer samen vrijgeven.
+void	FakeApplication::batchScenario(int aantal, int batch, bool vflag)
+{
+    require(batch > 0);
+    bool old_vflag = this->vflag;
+    this->vflag = vflag;	// verbose mode aan/uit
+
+    oom_teller = 0;			// reset failure counter
+    err_teller = 0;			// reset error counter
+    alloc_teller = 0;		// reset alloc counter
+    free_teller = 0;		// reset free counter
+
+    srand(1);   			// altijd hetzelfde scenario (zie: randomscenario)
+
+    std::vector<int>	omvang(batch);		// de aanvraag van een request
+    std::vector<Area*>	gekregen(batch);	// en wat het kreeg
+    std::vector< std::vector<Area*> >	requests;	// de requests die nog leven
+
+    Stopwatch  klok;		// Een stopwatch om de tijd te meten
+    klok.start();			// -----------------------------------
+    for (int  x = 0 ; x < aantal ; ++x)
+    {
+        int  r = rand();					// Gooi de dobbelsteen
+        if (requests.empty() || vraagkans(r))
+        {
+            int  n = 1 + rand() % batch;	// hoeveel objecten deze keer
+            for (int k = 0 ; k < n ; ++k)
+                omvang[k] = 1 + rand() % (size / 100);	// maximaal 1% van alles
+            alloc_teller += n;
+            oom_teller += n - beheerder->allocBatch(&omvang[0], n, &gekregen[0]);
+
+            std::vector<Area*>  request;
+            for (int k = 0 ; k < n ; ++k)
+            {
+                Area  *ap = gekregen[k];
+                if (!ap)
+                    continue;
+                if (vflag)
+                    cout << "Vraag " << omvang[k] << ", kreeg " << (*ap) << endl;
+                if (overlapt(ap))			// Oeps! (zie: vraagGeheugen)
+                    ++err_teller;
+                onthoud(ap);
+                request.push_back(ap);
+            }
+            if (!request.empty())
+                requests.push_back(request);
+        }
+        else								// Anders: een request is klaar
+        {
+            size_t  m = rand() % requests.size();
+            std::vector<Area*>&  request = requests[m];
+            for (size_t k = 0 ; k < request.size() ; ++k)
+            {
+                if (vflag)
+                    cout << "Vrijgeven " << (*request[k]) << endl;
+                verwijder(zoek(request[k])->second);	// uit de lijst halen
+            }
+            free_teller += request.size();
+            beheerder->freeBatch(&request[0], request.size());	// en samen vrijgeven
+            request.swap(requests.back());	// de laatste komt op die plek
+            requests.pop_back();
+        }
+    }
+    klok.stop();			// -----------------------------------
+    elapsed = klok.gettotal();
+
+    if (qflag)  								// quiet: the caller reports
+    {
+        this->vflag = old_vflag;
+        return;
+    }
+
+    klok.report();			// Vertel alle tijden
+    reportPerAlloc(klok);	// en de gemiddelde tijd per alloc
+    beheerder->report();	// en de geheugenbeheer statistieken
+
+    // Evaluatie
+    if ((oom_teller > 0) || (err_teller > 0) )  	// some errors
+    {
+        cout << AC_RED "De allocater faalde " << oom_teller << " keer";
+        cout << " en maakte " << err_teller << " fouten\n" AA_RESET;
+    }
+    else  										// no problems
+    {
+        cout << AC_GREEN "De allocater faalde " << oom_teller << " keer";
+        cout << " en maakte " << err_teller << " fouten\n" AA_RESET;
+    }
+
+    this->vflag = old_vflag; // turn on verbose output again
+}
+
+
+// Vertel hoeveel tijd er gemiddeld per alloc gebruikt werd.
+// NB Dit is de totale tijd van het scenario gedeeld door het aantal allocs,
+// de tijd van de free acties en van de applicatie zelf zit er dus ook in.
+void FakeApplication::reportPerAlloc(const Stopwatch& klok)
+{
+    if (alloc_teller > 0)
+    {
+        cout << alloc_teller << " allocs, "
+             << (klok.gettotal() * 1e9 / alloc_teller) << " ns per alloc\n";
+    }
+}
+
+
 int FakeApplication::kiesServlet(int nummer)
 {
-    cout << "het nummer " << nummer << endl;
+    if (!qflag)
+        cout << "het nummer " << nummer << endl;
     if (nummer == 1 || nummer == 2)
     {
         return 1;
@@ -326,6 +569,8 @@ void	FakeApplication::randomscenario(int aantal, bool vflag)
 
     oom_teller = 0;			// reset failure counter
     err_teller = 0;			// reset error counter
+    alloc_teller = 0;		// reset alloc counter
+    free_teller = 0;		// reset free counter
 
     // Door srand hier aan te roepen met een "seed" waarde
     // krijg je altijd een herhaling van hetzelfde scenario.
@@ -357,8 +602,16 @@ void	FakeApplication::randomscenario(int aantal, bool vflag)
         // dan doen we een keer niets
     }
     klok.stop();			// -----------------------------------
+    elapsed = klok.gettotal();
+
+    if (qflag)  								// quiet: the caller reports
+    {
+        this->vflag = old_vflag;
+        return;
+    }
 
     klok.report();			// Vertel alle tijden
+    reportPerAlloc(klok);	// en de gemiddelde tijd per alloc
     beheerder->report();	// en de geheugenbeheer statistieken
 
     // Evaluatie
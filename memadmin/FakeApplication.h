@@ -9,10 +9,16 @@
  *  @version 2.1	2009/02/22
  */
 
+#include <map>			// the STL std::multimap<> container
+#include <vector>		// the STL std::vector<> container
+
 // onze eigen includes
 #include "Allocator.h"	// baseclass Allocator
 #include "Area.h"		// class Area
 
+class Stopwatch;		// see: Stopwatch.h
+class Workload;			// see: Workload.h
+
 /// @class FakeApplication
 /// De namaak applicatie/tester/performance meter class.
 class FakeApplication
@@ -21,7 +27,10 @@ private:
 	Allocator	*beheerder;	// de huidige geheugenbeheers module
 	int			 size;		// de omvang van het beheerde geheugen
 
-	AreaList	 objecten;	// de lijst van de gekregen gebieden
+	std::vector<Area*>	objecten;	// de gekregen gebieden (in willekeurige volgorde,
+									// weghalen gaat door de laatste op die plek te zetten)
+	std::multimap<int, size_t>	adressen;	// begin adres -> plaats in 'objecten',
+									// om overlap in O(log n) te vinden
 
 	bool		 vflag;		// "verbose" mode;
 							// true als we willen zien wat er gebeurt
@@ -29,6 +38,9 @@ private:
 							// true als we de code willen "testen"
 							// anders gaan we "performance meten".
 							// (NOTE: iff true, it turns off the vflag)
+	bool		 qflag;		// "quiet" mode;
+							// true als een scenario niets mag afdrukken
+							// (b.v. voor een benchmark)
 
 public:
 
@@ -50,21 +62,54 @@ public:
 	// voer een minder random scenario uit(webbrowserish)
 	void minderRandomScenario(int aantal, bool vflag);
 
+	/// Voer een scenario uit volgens een instelbare werklast (zie Workload)
+	/// @param	w		de verdeling van omvang en levensduur
+	/// @param	aantal	hoe vaak wordt er alloc of free gedaan
+	/// @param	vflag	true=vertel wat er allemaal gebeurt
+	void workloadScenario(Workload& w, int aantal, bool vflag);
+
+	/// Voer een scenario uit dat geheugen per "request" aanvraagt:
+	/// een aantal objecten in een keer (allocBatch) die later ook
+	/// weer samen worden vrijgegeven (freeBatch).
+	/// @param	aantal	hoe vaak wordt er een batch gevraagd of vrijgegeven
+	/// @param	batch	hoeveel objecten er maximaal per request zijn
+	/// @param	vflag	true=vertel wat er allemaal gebeurt
+	void batchScenario(int aantal, int batch, bool vflag);
+
 	//
 	// voeg hier straks je eigen scenario(s) toe
 	//
 
+	/// Zet de "quiet" mode aan of uit
+	void	setQuiet(bool q)	{ qflag = q; }
+
+	// De resultaten van het laatste scenario
+	int		getAllocs() const	{ return alloc_teller; }	///< hoeveel allocs
+	int		getFrees() const	{ return free_teller; }		///< hoeveel frees
+	int		getOOM() const		{ return oom_teller; }		///< hoeveel allocs faalden
+	int		getErrors() const	{ return err_teller; }		///< hoeveel overlappingen
+	double	getTime() const		{ return elapsed; }			///< de gebruikte tijd (sec)
+
 private:
 
 	// interne hulpjes
-	void	vraagGeheugen(int omvang);
+	Area	*vraagGeheugen(int omvang);
 	void	vergeetOudste();
 	void	vergeetRandom();
+	void	vergeet(Area *ap);
+	void	onthoud(Area *ap);			// 'ap' bij de objecten zetten
+	Area	*verwijder(size_t plaats);	// het object op deze plaats weghalen
+	std::multimap<int, size_t>::iterator	zoek(Area *ap);	// 'ap' in de adressen
+	Area	*overlapt(Area *ap);		// met welk object overlapt 'ap' ?
 	int kiesServlet(int nummer);
+	void	reportPerAlloc(const Stopwatch& klok);
 
 	// for statistics
 	int		err_teller; // Errors teller
 	int		oom_teller; // Out-Of-Memory teller
+	int		alloc_teller; // Alloc teller (voor de tijd per alloc)
+	int		free_teller; // Free teller
+	double	elapsed;	// De tijd van het laatste scenario
 };
 
 #endif	/*FakeApplication_h*/
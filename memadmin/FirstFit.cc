@@ -4,6 +4,7 @@
  */
 
 #include "FirstFit.h"
+#include "AreaIndex.h"
 #include "ansi.h"
 
 
@@ -15,6 +16,7 @@ FirstFit::~FirstFit()
 		areas.pop_back();
 		delete ap;
 	}
+	delete index;
 }
 
 // Initializes how much memory we own
@@ -23,6 +25,10 @@ void  FirstFit::setSize(int new_size)
 	require(areas.empty());					// prevent changing the size when the freelist is nonempty
 	Fitter::setSize(new_size);
 	areas.push_back(new Area(0, new_size));	// and create the first free area (i.e. "all")
+	if (index) {							// and tag it
+		index->reset(new_size, areas.end());
+		index->add(areas.begin());
+	}
 }
 
 // Print the current freelist for debugging
@@ -52,12 +58,12 @@ Area  *FirstFit::alloc(int wanted)
 	Area  *ap = 0;
 	ap = searcher(wanted);		// first attempt
 	if(ap) {					// success ?
-		return ap;
+		return given(ap);
 	}
 	if(reclaim()) {			// could we reclaim fragmented freespace ?
 		ap = searcher(wanted);	// then make a second attempt
 		if(ap) {				// success ?
-			return ap;
+			return given(ap);
 		}
 	}
 	// Alas, failed to allocate anything
@@ -70,13 +76,31 @@ Area  *FirstFit::alloc(int wanted)
 void	FirstFit::free(Area *ap)
 {
 	require(ap != 0);
-	if (cflag) {
-		// EXPENSIVE: check for overlap with all registered free areas
-		for(ALiterator  i = areas.begin() ; i != areas.end() ; ++i) {
-			check(!ap->overlaps(*i));    // the sanity check
-		}
-	}
+	taken(ap);				// the sanity check (in check mode only)
 	areas.push_back(ap);	// add discarded "old" object to the end of free list
+	if (tailStart == areas.end())
+		--tailStart;		// it starts the unsorted tail
+}
+
+
+// Application wants several areas at once
+int		FirstFit::allocBatch(const int *sizes, int n, Area **out)
+{
+	require(n >= 0);
+	for (int k = 0 ; k < n ; ++k) {
+		require(sizes[k] > 0);		// has to be "something",
+		require(sizes[k] <= size);	// but not more than can exist
+		out[k] = 0;
+	}
+
+	updateStats();					// one search of the resource map
+
+	int  got = batchSearcher(sizes, n, out);	// first attempt
+	if ((got < n) && reclaim())					// could we reclaim fragmented freespace ?
+		got += batchSearcher(sizes, n, out);	// then make a second attempt for the rest
+	for (int k = 0 ; k < n ; ++k)
+		given(out[k]);
+	return got;
 }
 
 
@@ -90,52 +114,89 @@ Area  *FirstFit::searcher(int wanted)
 	require(!areas.empty());	// provided we do have something to give
 
 	// Search thru all available areas
+	int  probes = 0;					// statistics: areas looked at
 	for(ALiterator  i = areas.begin() ; i != areas.end() ; ++i) {
 		Area  *ap = *i;					// Candidate item
+		++probes;
 		if(ap->getSize() >= wanted) {	// Large enough?
+			searchProbes.add(probes);
 			// Yes, use this area;
 			// The 'erase' operation below invalidates the 'i' iterator
 			// but it does return a valid iterator to the next element.
+			if (index)
+				index->remove(ap);				// no longer free
+			bool  atTail = (i == tailStart);	// NB 'erase' would invalidate 'tailStart'
 			ALiterator  next = areas.erase(i);	// Remove this element from the freelist
 			if(ap->getSize() > wanted) {		// Larger than needed ?
 				Area  *rp = ap->split(wanted);	// Split into two parts (updating sizes)
-				areas.insert(next, rp);			// Insert remainder before "next" area
+				next = areas.insert(next, rp);	// Insert remainder before "next" area
+				if (index)
+					index->add(next);			// and tag the remainder
 			}
+			if (atTail)
+				tailStart = next;				// the remainder keeps its place
 			return  ap;
 		}
 	}
+	searchProbes.add(probes);
 	return  0; // report failure
 }
 
 
+// Search for several areas in one pass.
+// Each free area is offered to all open requests, in their order,
+// so every request gets the same area as it would from 'searcher'
+// when they were done one after the other.
+int		FirstFit::batchSearcher(const int *sizes, int n, Area **out)
+{
+	int  todo = 0;						// the open requests
+	for (int k = 0 ; k < n ; ++k) {
+		if (!out[k])
+			++todo;
+	}
+
+	int  got = 0;
+	int  probes = 0;					// statistics: areas looked at
+	for (ALiterator  i = areas.begin() ; (i != areas.end()) && (got < todo) ; ) {
+		++probes;
+		bool  gone = false;				// is this free area used up ?
+		for (int k = 0 ; (k < n) && !gone ; ++k) {
+			Area  *ap = *i;				// Candidate item
+			if (out[k] || (ap->getSize() < sizes[k]))
+				continue;
+			if (index)
+				index->remove(ap);				// no longer free
+			if (ap->getSize() > sizes[k]) {		// Larger than needed ?
+				*i = ap->split(sizes[k]);		// the remainder takes its place
+				if (index)
+					index->add(i);				// and is tagged
+			} else {
+				bool  atTail = (i == tailStart);	// NB 'erase' would invalidate 'tailStart'
+				i = areas.erase(i);				// used up: remove it from the freelist
+				if (atTail)
+					tailStart = i;
+				gone = true;
+			}
+			out[k] = ap;
+			++got;
+		}
+		if (!gone)
+			++i;
+	}
+	searchProbes.add(probes);
+	return got;
+}
+
+
 // We have run out of usefull areas;
 // Try to reclaim space by joining fragmented freespace
 bool	FirstFit::reclaim()
 {
 	require(!areas.empty());		// sanity check
 
-	// Sort resource map by area address
-	areas.sort(Area::orderByAddress());	// WARNING: expensive N*log(N) operation !
-
-	// Search thru all free areas for matches between successive elements
-	bool  changed = false;
-	ALiterator  i = areas.begin();
-	Area  *ap = *i;					// The current candidate ...
-	for(++i ; i != areas.end() ;) {
-		Area  *bp = *i;				// ... match it with.
-		if(bp->getBase() == (ap->getBase() + ap->getSize())) {
-			// Oke; bp matches ap ... [i.e. bp follows ap]
-			ALiterator  next = areas.erase(i);	// remove bp from the list
-			ap->join(bp);			// append area bp to ap (and destroy bp)
-			++mergers;				// update statistics
-			changed = true;			// we changed something
-			i = next;				// revive the 'i' iterator
-			// and now try match ap with whatever followed bp
-		} else {
-			ap = bp;				// move on to next free area
-			++i;
-		}
-	}
+	// Only the areas free'd since the last time need sorting,
+	// then merge and join them with the rest in one linear pass
+	bool  changed = coalesce(areas, tailStart);
 	++reclaims;	// update statistics ("reclaims attempted")
 	return changed;
 }
@@ -11,6 +11,8 @@
 
 #include "Fitter.h"
 
+class	AreaIndex;	// see: AreaIndex.h
+
 
 /// @class FirstFit
 /// Het FirstFit algorithme gebruikt het eerste
@@ -24,7 +26,7 @@ public:
 	/// @param cflag	initial status of check-mode
 	/// @param type		name of this algorithm (default=FirstFit)
 	FirstFit(bool cflag, const char *type = "FirstFit (lazy)")
-		: Fitter(cflag, type) {}
+		: Fitter(cflag, type), index(0), tailStart(areas.end()) {}
 
 	/// Cleanup free areas
 	~FirstFit();
@@ -39,10 +41,24 @@ public:
 	/// @param ap	The area returned to free space
 	virtual  void	free(Area *ap);
 
+	/// Ask for several areas, searching the resource map only once.
+	/// @returns	how many areas were given (a failed one is 0 in 'out')
+	virtual  int	allocBatch(const int *sizes, int n, Area **out);
+
+	/// Describe the resource map (see Allocator::freeSpace)
+	bool	 freeSpace(FreeSpace& fs)	{ countFree(areas, fs); return true; }
+
 protected:
 
 	/// List of all the available free areas
-	std::list<Area*>  areas;
+	AreaList  areas;
+
+	/// Boundary tags for 'areas' (only used by the indexed eager version)
+	AreaIndex	*index;
+
+	/// The areas before this one are sorted by address,
+	/// from here on they were free'd since the last reclaim.
+	ALiterator	tailStart;
 
 	/// For debugging this function shows the free area list
 	virtual	 void	dump();
@@ -51,6 +67,10 @@ protected:
 	/// @returns	An area or 0 if not enough freespace available
 	Area 	*searcher(int);
 
+	/// Serve all requests in 'out' that are still 0 in one pass over the resource map.
+	/// @returns	how many of them could be served
+	int		 batchSearcher(const int *sizes, int n, Area **out);
+
 	/// This function is called when the searcher can not find space.
 	/// It tries to reclaim fragmented space by merging adjacent free areas.
 	/// @returns true if free areas could be merged, false if no adjacent areas exist
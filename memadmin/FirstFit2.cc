@@ -4,6 +4,16 @@
  */
 
 #include "FirstFit2.h"
+#include "AreaIndex.h"
+
+
+// The indexed version (if so requested)
+FirstFit2::FirstFit2(bool cflag, bool indexed)
+	: FirstFit(cflag, indexed ? "FirstFit (eager, indexed)" : "FirstFit (eager)")
+{
+	if (indexed)
+		index = new AreaIndex;
+}
 
 
 // ----- hulpfuncties -----
@@ -12,13 +22,20 @@
 void	FirstFit2::free(Area *ap)
 {
 	require(ap != 0);
+	taken(ap);					// the sanity check (in check mode only)
+
+	if (index) {
+		ALiterator  dummy = areas.end();		// FirstFit has no cursor to protect
+		mergers += index->insert(areas, ap, dummy);	// O(1) merge with both neighbours
+		return;
+	}
 
 	// Find the right place to insert ap, keeping the list sorted by address
+	int  probes = 0;							// statistics: areas looked at
 	for (ALiterator  i = areas.begin() ; i != areas.end() ; )
 	{
 		Area  *bp = *i;							// match new ap with existing bp ...
-		if (cflag)
-			check(!ap->overlaps(bp));    		// sanity check
+		++probes;
 		// Does older area bp match new free area ap?
 		if (bp->getBase() == (ap->getBase() + ap->getSize())) {
 			// Yes, bp matches with ap ...	[ap directly before bp]
@@ -26,6 +43,7 @@ void	FirstFit2::free(Area *ap)
 			ap->join(bp);						// append area bp to ap (and destroy bp)
 			++mergers;							// update statistics
 			areas.insert(next, ap);				// insert ap before next
+			freeProbes.add(probes);
 			return;
 		} else
 		if (ap->getBase() == (bp->getBase() + bp->getSize())) {
@@ -40,6 +58,7 @@ void	FirstFit2::free(Area *ap)
 		if (ap->getBase() < bp->getBase()) {
 			// To keep the list sorted by address ap should go before bp
 			areas.insert(i, ap);				// insert ap before cursor
+			freeProbes.add(probes);
 			return;
 		} else {
 			++i;								// move on to next area in the freelist
@@ -47,7 +66,40 @@ void	FirstFit2::free(Area *ap)
 	}
 
 	// Found no match
+	freeProbes.add(probes);
 	areas.push_back(ap);	// then ap goes at the end
 }
 
+// Return several areas at once
+void	FirstFit2::freeBatch(Area **batch, int n)
+{
+	require(n >= 0);
+	if (index) {
+		Allocator::freeBatch(batch, n);			// O(1) per area already
+		return;
+	}
+
+	// Put them all behind the sorted list,
+	// then one sort and one merge (see Fitter::coalesce)
+	ALiterator  tail = areas.end();
+	for (int k = 0 ; k < n ; ++k) {
+		require(batch[k] != 0);
+		taken(batch[k]);						// the sanity check (in check mode only)
+		areas.push_back(batch[k]);
+		if (tail == areas.end())
+			--tail;								// the first of the batch
+	}
+	coalesce(areas, tail);
+	freeProbes.add(areas.size());				// statistics: one pass for the whole batch
+}
+
+// Nothing to reclaim when the neighbours are always merged immediately
+bool	FirstFit2::reclaim()
+{
+	if (!index)
+		return FirstFit::reclaim();
+	++reclaims;	// update statistics ("reclaims attempted")
+	return false;
+}
+
 // vim:sw=4:ai:aw:ts=4:
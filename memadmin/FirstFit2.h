@@ -18,6 +18,9 @@
 /// Dit is de eager versie (probeert meteen alles op
 /// te ruimen en houdt daarom de gebieden gesorteerd
 /// op adres)
+/// De indexed versie gebruikt boundary tags (zie AreaIndex) om de buren van
+/// een teruggegeven gebied in O(1) te vinden. Gebieden zonder vrije buren
+/// komen dan achteraan de lijst, die is dus niet meer gesorteerd op adres.
 class	FirstFit2 : public FirstFit
 {
 public:
@@ -28,10 +31,25 @@ public:
 	FirstFit2(bool cflag, const char *type = "FirstFit (eager)")
 		: FirstFit(cflag, type) {}
 
+	/// @param cflag	initial status of check-mode
+	/// @param indexed	use boundary tags to find the neighbours of a free'd area
+	FirstFit2(bool cflag, bool indexed);
+
 	/// The application returns an area to freespace
 	/// @param ap	The area returned to free space
 	virtual  void	 free(Area *ap);
 
+	/// Return several areas: they are sorted and merged with
+	/// the resource map in one pass (the boundary tags
+	/// of the indexed version do that per area anyway)
+	virtual  void	 freeBatch(Area **areas, int n);
+
+protected:
+
+	/// With boundary tags every area is merged when it is free'd,
+	/// so there is never anything left to reclaim.
+	virtual	 bool	 reclaim();
+
 };
 
 #endif	/*FirstFit2_h*/
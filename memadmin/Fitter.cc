@@ -4,6 +4,9 @@
  */
 
 #include <cmath>		// for: sqrt(3) [needs -lm]
+#include <string>		// std::string
+#include <vector>		// std::vector
+#include <algorithm>	// std::sort, std::upper_bound
 #include "ansi.h"		// ansi color codes
 
 #include "Fitter.h"
@@ -11,7 +14,7 @@
 
 Fitter::Fitter(bool cflag, const char *type)
 	: Allocator(cflag, type)
-	, reclaims(0), mergers(0)
+	, reclaims(0), mergers(0), sorted(0)
 	, qcnt(0), qsum(0), qsum2(0)
 {
 }
@@ -23,7 +26,11 @@ void  Fitter::setSize(int new_size)
 	require(new_size > 0);					// must be a meaningfull value
 	Allocator::setSize(new_size);			// inform the Allocator baseclass about the new size
 	reclaims = mergers = 0;					// clear the statistics
+	sorted = 0;
 	qcnt = qsum = qsum2 = 0;				// and these too
+	searchProbes.clear();
+	freeProbes.clear();
+	checker.reset(new_size);
 }
 
 
@@ -31,24 +38,173 @@ void  Fitter::setSize(int new_size)
 void	Fitter::report()
 {
 	std::cout << type << ": " << reclaims << " reclaims, " << mergers << " mergers\n";
-
-	require(qcnt > 0);			// prevent divide-thru-zero
-	double	avg = qsum / qcnt;	// calculate the average resource map length
+	if (sorted > 0) {
+		std::cout << type << ": " << sorted << " areas sorted";
+		if (reclaims > 0)		// NB a batch free sorts too (see FirstFit2::freeBatch)
+			std::cout << ", " << (double(sorted) / reclaims) << " per reclaim";
+		std::cout << '\n';
+	}
 
 	require(qcnt > 1);			// prevent divide-thru-zero
-	double	stdev				// calculate the standard deviation
-		= sqrt(
-			  (qsum2 / (qcnt - 1))
-			  -
-			  (qcnt / (qcnt - 1)) * (((qsum / qcnt) * (qsum / qcnt)))
-		  );
-	// also see: http://en.wikipedia.org/wiki/Standard_deviation
+	double	avg = getAverage();		// the average resource map length
+	double	stdev = getStdev();		// and the standard deviation
 	std::cout << type << ": average " << avg << " areas, stdev " << stdev << " areas\n";
 	// Assuming a normal distribution, then:
 	// 68% of the time the map length will be avg +/- stdev		[one-sigma]
 	// 95% of the time the map length will be avg +/- (2*stdev)	[two-sigma]
 	// 99.7% of the time it will be within 3-sigma
+
+	// The distribution of the number of areas looked at
+	std::string  title(type);
+	if (searchProbes.count() > 0)
+		searchProbes.report((title + ": probes per search").c_str(), "areas");
+	if (freeProbes.count() > 0)
+		freeProbes.report((title + ": probes per free").c_str(), "areas");
+}
+
+
+// The average length of the resource map
+double	Fitter::getAverage() const
+{
+	if (qcnt == 0)				// prevent divide-thru-zero
+		return 0.0;
+	return double(qsum) / qcnt;
+}
+
+// The standard deviation of the length of the resource map
+double	Fitter::getStdev() const
+{
+	if (qcnt < 2)				// prevent divide-thru-zero
+		return 0.0;
+	double	n = qcnt;
+	double	avg = double(qsum) / n;
+	double	var = (double(qsum2) - n * avg * avg) / (n - 1);
+	return (var > 0) ? sqrt(var) : 0.0;
+	// also see: http://en.wikipedia.org/wiki/Standard_deviation
+}
+
+// Merge the unsorted tail into the sorted front and join neighbours
+bool	Fitter::coalesce(AreaList& areas, ALiterator& tail)
+{
+	// Only sort the areas that were free'd since the last time ...
+	AreaList  fresh;
+	fresh.splice(fresh.begin(), areas, tail, areas.end());
+	sorted += fresh.size();						// update statistics
+	fresh.sort(Area::orderByAddress());
+	// ... and merge them with the already sorted areas in one pass
+	areas.merge(fresh, Area::orderByAddress());
+	tail = areas.end();							// nothing unsorted anymore
+
+	// Search thru all free areas for matches between successive elements
+	bool  changed = false;
+	if (areas.empty())
+		return changed;
+	ALiterator  i = areas.begin();
+	Area  *ap = *i;					// The current candidate ...
+	for (++i ; i != areas.end() ;) {
+		Area  *bp = *i;				// ... match it with.
+		if (bp->getBase() == (ap->getBase() + ap->getSize())) {
+			// Oke; bp matches ap ... [i.e. bp follows ap]
+			ALiterator  next = areas.erase(i);	// remove bp from the list
+			ap->join(bp);			// append area bp to ap (and destroy bp)
+			++mergers;				// update statistics
+			changed = true;			// we changed something
+			i = next;				// revive the 'i' iterator
+		} else {
+			ap = bp;				// move on to next free area
+			++i;
+		}
+	}
+	return changed;
 }
 
 
+namespace {
+
+/// An area in the neighbourhood of a free'd batch (see Fitter::mergeBatch)
+struct	Piece
+{
+	Area		*ap;	///< the area
+	ALiterator	 it;	///< its place in the resource map (a neighbour only)
+	int			 seen;	///< when the walk found it (-1 for the batch itself)
+
+	Piece(Area *ap, ALiterator it, int seen) : ap(ap), it(it), seen(seen) {}
+
+	/// order by address
+	bool	operator<(const Piece& that) const	{ return ap->getBase() < that.ap->getBase(); }
+};
+
+}
+
+// Return a batch of areas to an unsorted resource map and merge them
+void	Fitter::mergeBatch(AreaList& areas, Area **batch, int n, ALiterator& cursor)
+{
+	// Sort the batch and join the areas that are neighbours of each other
+	std::vector<Area*>  runs;
+	for (int k = 0 ; k < n ; ++k) {
+		require(batch[k] != 0);
+		taken(batch[k]);						// the sanity check (in check mode only)
+		runs.push_back(batch[k]);
+	}
+	std::sort(runs.begin(), runs.end(), Area::orderByAddress());
+	std::vector<Piece>  pieces;
+	for (int k = 0 ; k < n ; ++k) {
+		Area  *ap = runs[k];
+		if (!pieces.empty() && (pieces.back().ap->getBase() + pieces.back().ap->getSize() == ap->getBase())) {
+			pieces.back().ap->join(ap);			// append area ap to the previous one
+			++mergers;							// update statistics
+		} else {
+			pieces.push_back(Piece(ap, areas.end(), -1));
+		}
+	}
+	runs.clear();
+	for (unsigned k = 0 ; k < pieces.size() ; ++k)
+		runs.push_back(pieces[k].ap);			// the joined batch, still sorted
+
+	// One pass over the resource map to find the free neighbours
+	int  seen = 0;								// statistics: areas looked at
+	for (ALiterator  i = areas.begin() ; i != areas.end() ; ++i, ++seen) {
+		Area  *bp = *i;
+		std::vector<Area*>::iterator  r = std::upper_bound(runs.begin(), runs.end(), bp, Area::orderByAddress());
+		if ( ((r != runs.end()) && ((*r)->getBase() == (bp->getBase() + bp->getSize())))				// bp before *r ?
+		  || ((r != runs.begin()) && (bp->getBase() == ((*(r-1))->getBase() + (*(r-1))->getSize()))) )	// bp after r[-1] ?
+			pieces.push_back(Piece(bp, i, seen));
+	}
+	freeProbes.add(seen);						// statistics: one pass for the whole batch
+
+	// Join all adjacent pieces, every group ends up in one place
+	std::sort(pieces.begin(), pieces.end());
+	for (unsigned k = 0 ; k < pieces.size() ; ) {
+		Area  *ap = pieces[k].ap;				// the lowest area of this group
+		int   last = (pieces[k].seen >= 0) ? k : -1;	// the neighbour found last
+		unsigned  g = k + 1;
+		for ( ; (g < pieces.size()) && (pieces[g].ap->getBase() == (ap->getBase() + ap->getSize())) ; ++g) {
+			ap->join(pieces[g].ap);				// append it to ap (and destroy it)
+			++mergers;							// update statistics
+			if ((pieces[g].seen >= 0) && ((last < 0) || (pieces[g].seen > pieces[last].seen)))
+				last = g;
+		}
+		for (unsigned j = k ; j < g ; ++j) {	// remove the other neighbours from the list
+			if ((pieces[j].seen < 0) || ((int)j == last))
+				continue;
+			if (pieces[j].it == cursor)			// NB 'erase' would invalidate 'cursor'
+				cursor = areas.erase(pieces[j].it);
+			else
+				areas.erase(pieces[j].it);
+		}
+		if (last >= 0)
+			*pieces[last].it = ap;				// ap takes the place of that neighbour
+		else
+			areas.push_back(ap);				// found no match: ap goes at the end
+		k = g;
+	}
+}
+
+// Count the areas of a resource map as free space
+void	Fitter::countFree(const AreaList& areas, FreeSpace& fs)
+{
+	for (AreaList::const_iterator  i = areas.begin() ; i != areas.end() ; ++i)
+		fs.add((*i)->getSize());
+}
+
 // vim:sw=4:ai:aw:ts=4:
@@ -11,6 +11,8 @@
 
 #include "main.h"
 #include "Allocator.h"
+#include "Histogram.h"
+#include "AreaChecker.h"
 
 
 /// @class Fitter
@@ -29,6 +31,12 @@ public:
 
 	void	 report();				///< report statistics
 
+	// The statistics, e.g. for a benchmark
+	int		getReclaims() const	{ return reclaims; }	///< reclaims attempted
+	int		getMergers() const	{ return mergers; }		///< areas merged
+	double	getAverage() const;		///< average length of the resource map
+	double	getStdev() const;		///< and its standard deviation
+
 protected:
 
 	/// This is the actual function that searches for free space
@@ -39,16 +47,58 @@ protected:
 	/// @returns true if adjacent areas could be merged
 	virtual	 bool	  reclaim() = 0;		// A "pure-virtual function"
 
+	/// A reclaim helper for the lazy list based fitters.
+	/// The part of 'areas' before 'tail' is sorted by address,
+	/// the areas from 'tail' onwards were free'd later.
+	/// Only that tail is sorted, merged with the sorted part and then
+	/// adjacent areas are joined in a single linear pass.
+	/// @param areas	the resource map
+	/// @param tail		the first unsorted area, afterwards areas.end()
+	/// @returns true if adjacent areas could be merged
+	bool	coalesce(AreaList& areas, ALiterator& tail);
+
+	/// A freeBatch helper for the eager versions with an unsorted resource map.
+	/// The batch is sorted and joined, then one pass over 'areas' finds all
+	/// free neighbours. Like a single free, a merged area takes the place
+	/// of the neighbour that was found last; without neighbours it goes
+	/// at the end.
+	/// @param areas	the resource map
+	/// @param batch	the areas returned to free space
+	/// @param n		how many there are
+	/// @param cursor	kept valid when a neighbour is removed from 'areas'
+	void	mergeBatch(AreaList& areas, Area **batch, int n, ALiterator& cursor);
+
+	/// A freeSpace helper for the list based fitters: every area in the
+	/// resource map counts, so a lazy version shows the fragments it
+	/// searches and not the areas they would merge into.
+	static void	countFree(const AreaList& areas, FreeSpace& fs);
+
+	/// Check mode: remember an area that 'alloc' hands out.
+	/// @returns	'ap' (so that 'alloc' can say: return given(ap);)
+	Area	*given(Area *ap)		{ if (cflag && ap) checker.given(ap); return ap; }
+
+	/// Check mode: verify an area that is given back to 'free'.
+	/// This replaces comparing it with every free area.
+	void	 taken(const Area *ap)	{ if (cflag) checker.taken(ap); }
+
 
 	// Counters to maintain some simple statistics
 	int		reclaims;	///< how often we have tried to reclaim fragmented space
 	int		mergers;	///< how often we could merge fragmented space
+	long long	sorted;	///< how many areas had to be sorted by 'coalesce'
 
 	// Counters to calculate the average size of the resource map
 	long long	qcnt;	///< number of allocs tried
 	long long	qsum;	///< sum of areas.size()
 	long long	qsum2;	///< sum of areas.size() squared
 
+	// The real cost of a search does not depend on the length of the
+	// resource map but on how many areas have to be looked at.
+	Histogram	searchProbes;	///< areas probed per search
+	Histogram	freeProbes;		///< areas probed per free (the eager versions)
+
+	AreaChecker	checker;		///< the areas in use (check mode only)
+
 };
 
 
@@ -0,0 +1,168 @@
+/** @file FragMonitor.cc
+ * De implementatie van FragMonitor.
+ */
+
+#include "main.h"
+#include "FragMonitor.h"
+
+
+FragMonitor::FragMonitor(Allocator *inner, int every, int threshold)
+	: Wrapper(inner), every(every), threshold(threshold), ops(0), exact(false)
+	, total(0), small(0), taken(0)
+{
+	require(every > 0);
+	require(threshold >= 0);
+}
+
+// Initializes how much memory we own: one big hole
+void	FragMonitor::setSize(int new_size)
+{
+	Wrapper::setSize(new_size);
+	FreeSpace  fs(threshold);
+	exact = inner->freeSpace(fs);	// can the inner allocator tell us ?
+	used.clear();
+	holes.clear();
+	total = small = 0;
+	ops = taken = 0;
+	if (!exact)
+		addHole(new_size);
+}
+
+
+// Application wants 'wanted' memory
+Area	*FragMonitor::alloc(int wanted)
+{
+	Area  *ap = inner->alloc(wanted);
+	if (ap && !exact) {
+		int  base = ap->getBase();
+		int  end = base + ap->getSize();
+		// Find the neighbours of the new area, they bound the hole it came from
+		std::map<int,int>::iterator  next = used.lower_bound(base);
+		int  lo = 0;
+		if (next != used.begin()) {
+			std::map<int,int>::iterator  prev = next;
+			--prev;
+			lo = prev->first + prev->second;
+		}
+		int  hi = (next == used.end()) ? size : next->first;
+		check(lo <= base && end <= hi);		// it must fit in the hole
+		removeHole(hi - lo);
+		addHole(base - lo);
+		addHole(hi - end);
+		used.insert(next, std::make_pair(base, ap->getSize()));
+	}
+	tick();
+	return ap;
+}
+
+// Application returns an area no longer needed
+void	FragMonitor::free(Area *ap)
+{
+	std::map<int,int>::iterator  i = exact ? used.end() : used.find(ap->getBase());
+	if (i != used.end() && i->second == ap->getSize()) {
+		// The holes on both sides become one
+		int  lo = 0;
+		if (i != used.begin()) {
+			std::map<int,int>::iterator  prev = i;
+			--prev;
+			lo = prev->first + prev->second;
+		}
+		std::map<int,int>::iterator  next = i;
+		++next;
+		int  hi = (next == used.end()) ? size : next->first;
+		removeHole(i->first - lo);
+		removeHole(hi - (i->first + i->second));
+		addHole(hi - lo);
+		used.erase(i);
+	}	// else: not ours (e.g. freed twice), let the inner allocator complain
+	inner->free(ap);			// NB this may destroy 'ap'
+	tick();
+}
+
+// The current state of the free space
+FreeSpace	FragMonitor::getState()
+{
+	FreeSpace  fs(threshold);
+	if (exact) {
+		inner->freeSpace(fs);
+	} else {
+		fs.total = total;
+		fs.largest = holes.empty() ? 0 : *holes.rbegin();
+		fs.areas = int(holes.size());
+		fs.small = small;
+	}
+	return fs;
+}
+
+// The external fragmentation index
+double	FragMonitor::getIndex(const FreeSpace& fs)
+{
+	if (fs.total == 0)
+		return 0.0;
+	return 1.0 - double(fs.largest) / fs.total;
+}
+
+// Report statistics and the time series
+void	FragMonitor::report()
+{
+	inner->report();
+	FreeSpace  fs = getState();
+	std::cout << type << ": " << fs.total << " units free in " << fs.areas
+			  << " areas, largest " << fs.largest
+			  << ", fragmentation " << getIndex(fs)
+			  << ", " << fs.small << " areas < " << threshold
+			  << (exact ? "" : " (gaps between the areas)") << '\n';
+
+	long long  first = (taken > RING) ? (taken - RING) : 0;
+	std::cout << type << ": samples every " << every << " operations\n";
+	std::cout << "op,free,largest,areas,small,index\n";
+	for (long long n = first ; n < taken ; ++n) {
+		const Sample&  s = ring[n % RING];
+		std::cout << s.op << ',' << s.total << ',' << s.largest << ','
+				  << s.holes << ',' << s.small << ','
+				  << (s.total ? 1.0 - double(s.largest) / s.total : 0.0) << '\n';
+	}
+}
+
+
+// ----- internal utilities -----
+
+// A hole of 'hsize' units appeared
+void	FragMonitor::addHole(int hsize)
+{
+	if (hsize == 0)
+		return;
+	holes.insert(hsize);
+	total += hsize;
+	if (hsize < threshold)
+		++small;
+}
+
+// A hole of 'hsize' units disappeared
+void	FragMonitor::removeHole(int hsize)
+{
+	if (hsize == 0)
+		return;
+	std::multiset<int>::iterator  i = holes.find(hsize);
+	require(i != holes.end());
+	holes.erase(i);
+	total -= hsize;
+	if (hsize < threshold)
+		--small;
+}
+
+// Count an operation and take a sample every so often
+void	FragMonitor::tick()
+{
+	if (++ops % every)
+		return;
+	FreeSpace  fs = getState();
+	Sample&  s = ring[taken++ % RING];
+	s.op = ops;
+	s.total = fs.total;
+	s.largest = fs.largest;
+	s.holes = fs.areas;
+	s.small = fs.small;
+}
+
+// vim:sw=4:ai:aw:ts=4:
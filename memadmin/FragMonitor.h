@@ -0,0 +1,91 @@
+#pragma once
+#ifndef	__FragMonitor_h__
+#define	__FragMonitor_h__	1.0
+
+/** @file FragMonitor.h
+ *  @brief An Allocator wrapper that records how fragmented the free space gets.
+ */
+
+#include <map>			// the STL std::map<> container
+#include <set>			// the STL std::multiset<> container
+#include "Wrapper.h"
+
+
+/// @class FragMonitor
+/// Houdt bij hoe versnipperd het vrije geheugen van de inner allocator is.
+/// Om de 'every' operaties wordt een meting in een ring gezet:
+/// het totaal vrij, het grootste vrije gebied, het aantal vrije gebieden,
+/// het aantal onbruikbaar kleine gebieden en de fragmentatie index
+/// (1 - grootste/totaal). Het rapport laat die meetreeks zien.
+/// De meting komt van de inner allocator zelf (zie Allocator::freeSpace):
+/// de vrije gebieden die hij echt doorzoekt, dus bij een luie allocator
+/// de nog niet samengevoegde stukken, en zonder de interne fragmentatie
+/// van b.v. Buddy of McKusick-Karels. Dat kost een keer de vrije lijsten
+/// aflopen per meting, niets per alloc of free.
+/// Kan de inner allocator dat niet vertellen, dan worden alle allocs en
+/// frees gevolgd en gelden de gaten tussen de uitgegeven gebieden als
+/// vrij geheugen, bijgewerkt in O(log n) per operatie. NB: dat klopt
+/// alleen als een Area het hele blok beslaat dat de allocator er voor
+/// gebruikt, en het zijn de gaten in de adresruimte, niet de vrije lijst.
+class	FragMonitor : public Wrapper
+{
+public:
+
+	/// @param inner		the allocator that does the real work (see Wrapper)
+	/// @param every		take a sample every so many allocs and frees
+	/// @param threshold	free areas smaller than this are "unusable"
+	FragMonitor(Allocator *inner, int every, int threshold);
+
+	void	 setSize(int new_size);	///< initialize memory size
+
+	/// Ask the inner allocator for an area of 'wanted' units.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// Return an area to the inner allocator.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	void	 report();		///< report the statistics and the time series
+
+	/// The current state of the free space:
+	/// from the inner allocator if it can tell, else from the gaps.
+	FreeSpace	getState();
+
+	/// The external fragmentation index: 1 - largest/total
+	static double	getIndex(const FreeSpace& fs);
+
+private:
+
+	/// One sample of the time series
+	struct	Sample {
+		long long	op;			///< after this many operations
+		int			total;		///< total free units
+		int			largest;	///< the largest free area
+		int			holes;		///< number of free areas
+		int			small;		///< number of free areas < threshold
+	};
+
+	enum { RING = 1024 };		///< how many samples are kept (the newest)
+
+	int		every;				///< sample interval
+	int		threshold;			///< size of a still usable free area
+	long long	ops;			///< allocs and frees done
+	bool	exact;				///< the inner allocator reports its own free space
+
+	// The fallback: the gaps between the areas given out
+	std::map<int,int>	used;	///< the areas given out: base -> size
+	std::multiset<int>	holes;	///< the sizes of the gaps between them
+	int		total;				///< sum of the holes
+	int		small;				///< holes < threshold
+
+	Sample	ring[RING];			///< the time series (a circular buffer)
+	long long	taken;			///< samples taken so far
+
+	void	addHole(int hsize);		///< a gap appeared
+	void	removeHole(int hsize);	///< a gap disappeared
+	void	tick();					///< count an operation, maybe take a sample
+};
+
+#endif	/*FragMonitor_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,87 @@
+/** @file Histogram.cc
+ * De implementatie van Histogram.
+ */
+
+#include "main.h"
+#include "Histogram.h"
+
+
+// Forget all samples
+void	Histogram::clear()
+{
+	for (int i = 0 ; i < NBUCKETS ; ++i)
+		counts[i] = 0;
+	n = sum = lo = hi = 0;
+}
+
+// Add one sample
+void	Histogram::add(long long value)
+{
+	if (value < 0)			// a clock that went backwards
+		value = 0;
+	++counts[bucketOf(value)];
+	if (n == 0 || value < lo)
+		lo = value;
+	if (value > hi)
+		hi = value;
+	++n;
+	sum += value;
+}
+
+// The value below which 'p' percent of the samples fall
+long long	Histogram::percentile(double p) const
+{
+	require(p >= 0 && p <= 100);
+	if (n == 0)
+		return 0;
+	long long  rank = (long long)(p / 100.0 * n + 0.5);	// how many samples must be below
+	if (rank < 1)
+		rank = 1;
+	long long  seen = 0;
+	for (int i = 0 ; i < NBUCKETS ; ++i) {
+		seen += counts[i];
+		if (seen >= rank) {
+			long long  v = upperOf(i);
+			return (v < hi) ? v : hi;	// never more than the real maximum
+		}
+	}
+	notreached();
+	return hi;
+}
+
+// Print a summary on one line
+void	Histogram::report(const char *title, const char *unit, double scale) const
+{
+	std::cout << title << ": " << n << " samples, mean " << (mean() * scale) << ' ' << unit
+			  << ", p50 " << (percentile(50) * scale)
+			  << ", p90 " << (percentile(90) * scale)
+			  << ", p99 " << (percentile(99) * scale)
+			  << ", p99.9 " << (percentile(99.9) * scale)
+			  << ", max " << (hi * scale) << ' ' << unit << '\n';
+}
+
+
+// ----- internal utilities -----
+
+// The first 2^SUBBITS buckets hold one value each, after that
+// each power of two gets 2^SUBBITS buckets.
+int	Histogram::bucketOf(long long value)
+{
+	if (value < SUBCOUNT)
+		return int(value);
+	int  msb = 63 - __builtin_clzll((unsigned long long)value);
+	int  shift = msb - SUBBITS;
+	return ((shift + 1) << SUBBITS) + int((value >> shift) & (SUBCOUNT - 1));
+}
+
+// The inverse of bucketOf: the largest value that lands in 'bucket'
+long long	Histogram::upperOf(int bucket)
+{
+	if (bucket < SUBCOUNT)
+		return bucket;
+	int  shift = (bucket >> SUBBITS) - 1;
+	long long  low = (long long)(SUBCOUNT + (bucket & (SUBCOUNT - 1))) << shift;
+	return low + ((1LL << shift) - 1);
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,57 @@
+/** @file LatencyProfiler.cc
+ * De implementatie van LatencyProfiler.
+ */
+
+#include <string>		// std::string
+#include "main.h"
+#include "LatencyProfiler.h"
+
+
+LatencyProfiler::LatencyProfiler(Allocator *inner)
+	: Wrapper(inner), nsPerTick(1.0)
+{
+#if	L_RDTSC
+	// Calibrate the time stamp counter against nanotime()
+	long long  n0 = nanotime(), t0 = ticks();
+	long long  n1;
+	do {
+		n1 = nanotime();
+	} while (n1 - n0 < 20000000);		// 20 ms
+	nsPerTick = double(n1 - n0) / double(ticks() - t0);
+#endif
+}
+
+
+// Application wants 'wanted' memory
+Area	*LatencyProfiler::alloc(int wanted)
+{
+	long long  t0 = ticks();
+	Area  *ap = inner->alloc(wanted);
+	long long  t1 = ticks();
+	if (ap)
+		allocs.add(t1 - t0);
+	else
+		fails.add(t1 - t0);
+	return ap;
+}
+
+// Application returns an area no longer needed
+void	LatencyProfiler::free(Area *ap)
+{
+	long long  t0 = ticks();
+	inner->free(ap);
+	frees.add(ticks() - t0);
+}
+
+// Report statistics
+void	LatencyProfiler::report()
+{
+	inner->report();
+	std::string  title(type);
+	allocs.report((title + ": alloc").c_str(), "ns", nsPerTick);
+	if (fails.count() > 0)
+		fails.report((title + ": failed alloc").c_str(), "ns", nsPerTick);
+	frees.report((title + ": free").c_str(), "ns", nsPerTick);
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef	__LatencyProfiler_h__
+#define	__LatencyProfiler_h__	1.0
+
+/** @file LatencyProfiler.h
+ *  @brief An Allocator wrapper that measures the latency of every alloc and free.
+ */
+
+#include "Wrapper.h"
+#include "Histogram.h"
+
+
+// Select the clock by setting one #define to 1, and the other to 0.
+#define	L_RDTSC		0	///< x86: the time stamp counter (cheapest, calibrated at startup)
+#define	L_NANOTIME	1	///< anywhere: nanotime() from Histogram.h (clock_gettime)
+
+#if	(L_RDTSC+L_NANOTIME) != 1
+# error  Select exactly one clock for the LatencyProfiler
+#endif
+#if	L_RDTSC
+# include <x86intrin.h>		// __rdtsc()
+#endif
+
+
+/// @class LatencyProfiler
+/// Meet de tijd van elke afzonderlijke alloc en free van de inner allocator
+/// en houdt daarvan histogrammen bij (zie Histogram): apart voor gelukte
+/// allocs, mislukte allocs en frees. Zo worden de uitschieters zichtbaar
+/// (b.v. de alloc die een reclaim moest doen) die in het totaal van de
+/// Stopwatch verdwijnen. Per aanroep kost het twee klok-lezingen en een
+/// paar instructies, dus het kan aan blijven tijdens het meten.
+class	LatencyProfiler : public Wrapper
+{
+public:
+
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	/// @param inner	the allocator that does the real work (see Wrapper)
+	LatencyProfiler(Allocator *inner);
+
+	/// Ask the inner allocator for an area of 'wanted' units.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// Return an area to the inner allocator.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	void	 report();		///< report the statistics and the latencies
+
+protected:
+
+	Histogram	allocs;		///< latency of successful allocs
+	Histogram	fails;		///< latency of failed allocs
+	Histogram	frees;		///< latency of frees
+	double		nsPerTick;	///< to convert clock ticks to ns
+
+	/// Read the clock
+	static long long	ticks()
+	{
+#if	L_RDTSC
+		return (long long)__rdtsc();
+#else
+		return nanotime();
+#endif
+	}
+};
+
+#endif	/*LatencyProfiler_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,210 @@
+/** @file McKusickK.cc
+ * De implementatie van McKusickK.
+ */
+
+#include "McKusickK.h"
+#include "FirstFit2.h"	// the page pool
+
+
+McKusickK::McKusickK(bool cflag, const char *type)
+	: Allocator(cflag, type)
+	, pages(new FirstFit2(cflag, "McKusick-Karels page pool"))
+	, allocs(0), fails(0), wasted(0), inuse(0), peak(0), returned(0)
+{
+	for (int k = 0 ; k < NBUCKETS ; ++k)
+		buckets[k] = -1;
+}
+
+McKusickK::~McKusickK()
+{
+	for (size_t p = 0 ; p < kmem.size() ; ++p) {
+		delete kmem[p].run;		// the page pool does not know about these
+	}
+	delete pages;
+}
+
+// Initializes how much memory we own
+void  McKusickK::setSize(int new_size)
+{
+	require(kmem.empty());			// prevent changing the size after the first time
+	require(new_size >= PAGESIZE);	// we need at least one page
+	Allocator::setSize(new_size);
+	pages->setSize(new_size / PAGESIZE);	// NB a partial last page is not used
+	PageInfo  unused = { UNUSED, 0, 0, -1, -1, -1, 0 };
+	kmem.assign(new_size / PAGESIZE, unused);
+	link.assign(new_size, -1);
+}
+
+
+// Application wants 'wanted' memory
+Area  *McKusickK::alloc(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	Area  *ap = (wanted <= PAGESIZE / 2) ? allocSmall(wanted) : allocLarge(wanted);
+	if (ap)
+		++allocs;
+	else
+		++fails;
+	return ap;
+}
+
+
+// Application returns an area no longer needed
+void	McKusickK::free(Area *ap)
+{
+	require(ap != 0);
+	int  p = ap->getBase() / PAGESIZE;		// the page table tells us all
+	require(p < int(kmem.size()));
+	PageInfo&  pi = kmem[p];
+
+	if (pi.bucket == LARGE) {
+		if (cflag) {
+			check(ap->getBase() == p * PAGESIZE);	// must be the start of the run
+		}
+		wasted -= pi.run->getSize() * PAGESIZE - ap->getSize();
+		delete ap;
+		inuse -= pi.run->getSize();
+		returned += pi.run->getSize();
+		pi.bucket = UNUSED;
+		pages->free(pi.run);
+		pi.run = 0;
+		return;
+	}
+
+	int  k = pi.bucket;
+	if (cflag) {
+		check(k >= 0);										// page is in use
+		check((ap->getBase() & ((1 << k) - 1)) == 0);		// at a chunk boundary
+		check(pi.nfree < (PAGESIZE >> k));					// not all free already
+	}
+	int  c = ap->getBase();
+	wasted -= (1 << k) - ap->getSize();
+	delete ap;
+
+	link[c] = pi.freeHead;			// put the chunk on the free-list of its page
+	pi.freeHead = c;
+	if (pi.nfree++ == 0)			// page was full, now it has room again
+		linkPage(p, k);
+
+	if (pi.nfree == (PAGESIZE >> k)) {	// all chunks are free again
+		unlinkPage(p, k);
+		pi.bucket = UNUSED;
+		--inuse;
+		++returned;
+		pages->free(pi.run);			// give the page back to the page pool
+		pi.run = 0;
+	}
+}
+
+// Report statistics
+void	McKusickK::report()
+{
+	std::cout << type << ": " << allocs << " allocs, " << fails << " failed\n";
+	std::cout << type << ": " << inuse << " pages in use, at most " << peak
+			  << " of " << kmem.size() << ", " << returned << " pages returned\n";
+	std::cout << type << ": internal fragmentation " << wasted << " units now\n";
+}
+
+// The free chunks of the bucket pages, plus the free pages of the page pool.
+// The rest of a chunk, or of the last page of a large area, is internal waste.
+bool	McKusickK::freeSpace(FreeSpace& fs)
+{
+	for (size_t p = 0 ; p < kmem.size() ; ++p) {
+		int  k = kmem[p].bucket;
+		for (int c = 0 ; (k >= 0) && (c < kmem[p].nfree) ; ++c)
+			fs.add(1 << k);
+	}
+	// The page pool counts in pages
+	FreeSpace  pool((fs.threshold + PAGESIZE - 1) / PAGESIZE);
+	pages->freeSpace(pool);
+	fs.total += pool.total * PAGESIZE;
+	fs.areas += pool.areas;
+	fs.small += pool.small;
+	if (pool.largest * PAGESIZE > fs.largest)
+		fs.largest = pool.largest * PAGESIZE;
+	return true;
+}
+
+
+// ----- internal utilities -----
+
+// Add page p to the list of bucket k
+void	McKusickK::linkPage(int p, int k)
+{
+	kmem[p].prev = -1;
+	kmem[p].next = buckets[k];
+	if (buckets[k] >= 0)
+		kmem[buckets[k]].prev = p;
+	buckets[k] = p;
+}
+
+// Remove page p from the list of bucket k
+void	McKusickK::unlinkPage(int p, int k)
+{
+	if (kmem[p].prev >= 0)
+		kmem[kmem[p].prev].next = kmem[p].next;
+	else
+		buckets[k] = kmem[p].next;
+	if (kmem[p].next >= 0)
+		kmem[kmem[p].next].prev = kmem[p].prev;
+	kmem[p].next = kmem[p].prev = -1;
+}
+
+// Get a chunk from bucket 'k'
+Area	*McKusickK::allocSmall(int wanted)
+{
+	int  k = bucketOf(wanted);
+	int  p = buckets[k];
+	if (p < 0) {						// no page with free chunks
+		Area  *run = pages->alloc(1);	// then get a fresh page
+		if (!run)
+			return 0;
+		p = run->getBase();
+		PageInfo&  pi = kmem[p];
+		pi.bucket = k;
+		pi.nfree = PAGESIZE >> k;
+		pi.carved = 0;
+		pi.freeHead = -1;
+		pi.run = run;
+		linkPage(p, k);
+		if (++inuse > peak)
+			peak = inuse;
+	}
+
+	PageInfo&  pi = kmem[p];
+	int  c;
+	if (pi.freeHead >= 0) {				// reuse a free'd chunk
+		c = pi.freeHead;
+		pi.freeHead = link[c];
+	} else {							// or cut a new one
+		c = p * PAGESIZE + (pi.carved++ << k);
+	}
+	if (--pi.nfree == 0)				// page is full now
+		unlinkPage(p, k);
+
+	wasted += (1 << k) - wanted;
+	return new Area(c, wanted);
+}
+
+// Get whole pages for a large area
+Area	*McKusickK::allocLarge(int wanted)
+{
+	int  n = (wanted + PAGESIZE - 1) / PAGESIZE;
+	if (n > int(kmem.size()))
+		return 0;
+	Area  *run = pages->alloc(n);
+	if (!run)
+		return 0;
+	int  p = run->getBase();
+	kmem[p].bucket = LARGE;
+	kmem[p].run = run;
+	inuse += n;
+	if (inuse > peak)
+		peak = inuse;
+	wasted += n * PAGESIZE - wanted;
+	return new Area(p * PAGESIZE, wanted);
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,94 @@
+#pragma once
+#ifndef	__McKusickK_h__
+#define	__McKusickK_h__	1.0
+
+/** @file McKusickK.h
+ *  @brief The class that implements the McKusick-Karels allocator.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include "main.h"
+#include "Allocator.h"
+
+class	FirstFit2;		// see: FirstFit2.h
+
+
+/// @class McKusickK
+/// De McKusick-Karels allocator (zoals in de 4.3BSD kernel).
+/// Het geheugen bestaat uit pagina's van PAGESIZE eenheden die door een
+/// fit algoritme (de "page pool") uitgegeven worden. Kleine aanvragen
+/// worden afgerond op een macht van twee en komen uit een pagina die in
+/// zijn geheel voor die ene omvang (bucket) gebruikt wordt.
+/// Een tabel met een entry per pagina vertelt bij een free meteen
+/// om welke bucket het gaat: geen header en geen zoeken nodig.
+/// Aanvragen groter dan een halve pagina krijgen hele pagina's.
+/// Een pagina waarvan alle stukken weer vrij zijn gaat terug naar de page pool.
+class	McKusickK : public Allocator
+{
+public:
+
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	/// @param cflag	initial status of check-mode
+	/// @param type		name of this algorithm (default=McKusickK)
+	McKusickK(bool cflag, const char *type = "McKusick-Karels");
+
+	~McKusickK();			///< cleanup the page pool
+
+	void	 setSize(int new_size);	///< initialize memory size
+
+	/// Ask for an area of at least 'wanted' units.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// The application returns an area to freespace.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	bool	 freeSpace(FreeSpace& fs);	///< the free areas (see Allocator::freeSpace)
+
+	void	 report();		///< report statistics
+
+protected:
+
+	enum {
+		PAGESIZE = 128,		///< units per page (a power of two)
+		NBUCKETS = 7,		///< buckets 1,2,4 ... PAGESIZE/2
+		LARGE = -2,			///< page table: first page of a multi-page area
+		UNUSED = -1			///< page table: page belongs to the page pool
+	};
+
+	/// The page table ("kmemsizes")
+	struct PageInfo {
+		signed char	bucket;		///< the bucket of this page, LARGE or UNUSED
+		int		nfree;		///< free chunks in this page
+		int		carved;		///< chunks handed out at least once
+		int		freeHead;	///< address of the first free chunk, or -1
+		int		next;		///< next page of this bucket with free chunks, or -1
+		int		prev;		///< previous page of this bucket with free chunks, or -1
+		Area	*run;		///< what the page pool gave us (in page units)
+	};
+
+	FirstFit2	*pages;				///< the page pool
+	std::vector<PageInfo>	kmem;	///< one entry per page
+	std::vector<int>		link;	///< link[c] = next free chunk after chunk c
+	int			buckets[NBUCKETS];	///< first page with free chunks per bucket, or -1
+
+	// Statistics
+	long long	allocs;		///< successful allocations
+	long long	fails;		///< failed allocations
+	long long	wasted;		///< units currently lost to rounding up
+	int			inuse;		///< pages currently taken from the page pool
+	int			peak;		///< the highest value of 'inuse'
+	long long	returned;	///< pages given back to the page pool
+
+	/// The bucket for 'n' units (n <= PAGESIZE/2)
+	static int	bucketOf(int n)	{ return (n <= 1) ? 0 : 32 - __builtin_clz(unsigned(n - 1)); }
+
+	void	linkPage(int p, int k);		///< add page p to the list of bucket k
+	void	unlinkPage(int p, int k);	///< remove page p from the list of bucket k
+	Area	*allocSmall(int wanted);	///< get a chunk from a bucket
+	Area	*allocLarge(int wanted);	///< get whole pages
+};
+
+#endif	/*McKusickK_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -5,6 +5,7 @@
 
 #include "main.h"
 #include "NextFit.h"
+#include "AreaIndex.h"
 #include "ansi.h"
 
 
@@ -16,6 +17,7 @@ NextFit::~NextFit()
 		areas.pop_back();
 		delete ap;
 	}
+	delete index;
 }
 
 // Initializes how much memory we own
@@ -24,6 +26,10 @@ void  NextFit::setSize(int new_size)
 	require(areas.empty());					// prevent changing the size when the freelist is nonempty
 	Fitter::setSize(new_size);
 	areas.push_back(new Area(0, new_size));	// and create the first free area (i.e. "all")
+	if (index) {							// and tag it
+		index->reset(new_size, areas.end());
+		index->add(areas.begin());
+	}
 }
 
 // Print the current freelist for debugging
@@ -49,12 +55,12 @@ Area  *NextFit::alloc(int wanted)
 	Area  *ap = 0;
 	ap = searcher(wanted);		// first attempt
 	if (ap) {					// success ?
-		return ap;
+		return given(ap);
 	}
 	if (reclaim()) {			// could we reclaim fragmented areas
 		ap = searcher(wanted);	// second attempt
 		if (ap) {				// success ?
-			return ap;
+			return given(ap);
 		}
 	}
 	// Alas, failed to allocate anything
@@ -67,13 +73,31 @@ Area  *NextFit::alloc(int wanted)
 void	NextFit::free(Area *ap)
 {
 	require(ap != 0);
-	if (cflag) {
-		// EXPENSIVE: check for overlap with already registered free areas
-		for (ALiterator  i = areas.begin() ; i != areas.end() ; ++i) {
-			check(!ap->overlaps(*i));    // sanity check
-		}
-	}
+	taken(ap);				// sanity check (in check mode only)
 	areas.push_back(ap);	// de lazy version
+	if (tailStart == areas.end())
+		--tailStart;		// it starts the unsorted tail
+}
+
+
+// Application wants several areas at once
+int		NextFit::allocBatch(const int *sizes, int n, Area **out)
+{
+	require(n >= 0);
+	for (int k = 0 ; k < n ; ++k) {
+		require(sizes[k] > 0);		// minstens "iets",
+		require(sizes[k] <= size);	// maar niet meer dan we kunnen hebben.
+		out[k] = 0;
+	}
+
+	updateStats();					// one search of the resource map
+
+	int  got = batchSearcher(sizes, n, out);	// first attempt
+	if ((got < n) && reclaim())					// could we reclaim fragmented areas
+		got += batchSearcher(sizes, n, out);	// second attempt for the rest
+	for (int k = 0 ; k < n ; ++k)
+		given(out[k]);
+	return got;
 }
 
 
@@ -86,16 +110,28 @@ Area  *NextFit::searcher(int wanted)
 	require(wanted <= size);	// maar niet meer dan we kunnen hebben.
 
 	// Search thru all available areas
+	int  probes = 0;					// statistics: areas looked at
 	// start searching at the old cursor ...
 	for (ALiterator  i = cursor ; i != areas.end() ; ++i) {
 		Area  *ap = *i;					// Candidate item
+		++probes;
 		if (ap->getSize() >= wanted) {	// Large enough?
 			// Yes, use this area
+			searchProbes.add(probes);
+			if (index)
+				index->remove(ap);		// no longer free
+			bool  atTail = (i == tailStart);	// NB 'erase' would invalidate 'tailStart'
 			cursor = areas.erase(i);	// remove this element from the freelist,
 			// the next element becomes the new start-of-search cursor
 			if (ap->getSize() > wanted) {		// larger than needed?
 				Area  *rp = ap->split(wanted);	// split into two parts (updating sizes)
-				areas.insert(cursor, rp);		// add remainder before cursor
+				ALiterator  r = areas.insert(cursor, rp);	// add remainder before cursor
+				if (index)
+					index->add(r);				// and tag the remainder
+				if (atTail)
+					tailStart = r;				// the remainder keeps its place
+			} else if (atTail) {
+				tailStart = cursor;
 			}
 			return ap;
 		}
@@ -103,47 +139,93 @@ Area  *NextFit::searcher(int wanted)
 	// ... wrap around to beginning, search upto old cursor
 	for (ALiterator  i = areas.begin(); i != cursor; ++i) {
 		Area  *ap = *i;					// Candidate item
+		++probes;
 		if (ap->getSize() >= wanted) {	// Large enough?
 			// Yes, use this area
+			searchProbes.add(probes);
+			if (index)
+				index->remove(ap);		// no longer free
+			bool  atTail = (i == tailStart);	// NB 'erase' would invalidate 'tailStart'
 			cursor = areas.erase(i);	// remove this element from the freelist
 			// the next element becomes the new start-of-search cursor
 			if (ap->getSize() > wanted) {		// larger than needed?
 				Area  *rp = ap->split(wanted);	// split into two parts (updates sizes)
-				areas.insert(cursor, rp);		// add remainder to freelist
+				ALiterator  r = areas.insert(cursor, rp);	// add remainder to freelist
+				if (index)
+					index->add(r);				// and tag the remainder
+				if (atTail)
+					tailStart = r;				// the remainder keeps its place
+			} else if (atTail) {
+				tailStart = cursor;
 			}
 			return ap;
 		}
 	}
+	searchProbes.add(probes);
 	return 0; // report failure
 }
 
 
-// Try to join fragmented freespace
-bool	NextFit::reclaim()
+// Search for several areas in one walk round the resource map.
+// Like 'searcher' an area serves one request, after which the search
+// moves on to the next area; after a serve the walk may go round once
+// more, just like the search for the next request would.
+// Every area is offered to all open requests in their order, so a small
+// request may be served by an area that an earlier large request passed.
+int		NextFit::batchSearcher(const int *sizes, int n, Area **out)
 {
-	bool  changed = false;	// did we change anything ?
+	int  todo = 0;						// the open requests
+	for (int k = 0 ; k < n ; ++k) {
+		if (!out[k])
+			++todo;
+	}
 
-	// Sort resource map by area address
-	areas.sort( Area::orderByAddress() );	// WARNING: expensive N*log(N) operation !
-
-	// Search thru all available areas for matches
-	ALiterator  i = areas.begin();
-	Area  *ap = *i;				// the current candidate ...
-	for (++i ; i != areas.end() ;) {
-		Area  *bp = *i;			// ... match ap with ...
-		if (bp->getBase() == (ap->getBase() + ap->getSize()))
-		{
-			// oke, bp matches ap ...
-			ALiterator  next = areas.erase(i);	// remove bp from the list
-			ap->join(bp);			// append area bp to ap (and destroy bp)
-			++mergers;				// update statistics
-			changed = true;			// yes we changed something
-			i = next;				// revive the 'i' iterator
-		} else {
-			ap = bp;				// move on to next area
+	int  got = 0;
+	int  probes = 0;					// statistics: areas looked at
+	int  visits = areas.size();			// once round the resource map ...
+	ALiterator  i = cursor;
+	for ( ; (visits > 0) && (got < todo) ; --visits) {
+		if (i == areas.end())
+			i = areas.begin();			// wrap around
+		++probes;
+		Area  *ap = *i;					// Candidate item
+		int  k = 0;
+		while ((k < n) && (out[k] || (ap->getSize() < sizes[k])))
+			++k;						// the first open request that fits
+		if (k == n) {
+			++i;						// no use, move on
+			continue;
+		}
+		if (index)
+			index->remove(ap);			// no longer free
+		if (ap->getSize() > sizes[k]) {		// larger than needed?
+			*i = ap->split(sizes[k]);	// the remainder takes its place
+			if (index)
+				index->add(i);			// and is tagged
 			++i;
+		} else {
+			bool  atTail = (i == tailStart);	// NB 'erase' would invalidate 'tailStart'
+			i = areas.erase(i);			// used up: remove it from the freelist
+			if (atTail)
+				tailStart = i;
 		}
+		cursor = i;						// the next search starts after it
+		out[k] = ap;
+		++got;
+		visits = areas.size() + 1;		// ... after the last serve
 	}
+	searchProbes.add(probes);
+	return got;
+}
+
+// Try to join fragmented freespace
+bool	NextFit::reclaim()
+{
+	bool  changed = false;	// did we change anything ?
+
+	// Only the areas free'd since the last time need sorting,
+	// then merge and join them with the rest in one linear pass
+	changed = coalesce(areas, tailStart);
 	if (changed) {					// iff we have changed some area's the
 		cursor = areas.begin();		// next search should start at the (new) front
 	}
@@ -11,6 +11,8 @@
 
 #include "Fitter.h"
 
+class	AreaIndex;	// see: AreaIndex.h
+
 /// @class NextFit
 /// Het NextFit algorithme gebruikt het eerste
 /// gevonden bruikbare gebied in de resource map.
@@ -23,7 +25,7 @@ public:
 	/// @param cflag	initial status of check-mode
 	/// @param type		name of this algorithm (default=NextFit)
 	NextFit(bool cflag, const char *type = "NextFit (lazy)")
-		: Fitter(cflag, type), cursor(areas.begin()) {}
+		: Fitter(cflag, type), index(0), cursor(areas.begin()), tailStart(areas.end()) {}
 
 	/// Cleanup free areas
 	~NextFit();
@@ -38,17 +40,35 @@ public:
 	/// @param ap	The area returned to free space
 	void	free(Area *ap);
 
+	/// Ask for several areas, walking round the resource map only once.
+	/// @returns	how many areas were given (a failed one is 0 in 'out')
+	virtual  int	allocBatch(const int *sizes, int n, Area **out);
+
+	/// Describe the resource map (see Allocator::freeSpace)
+	bool	 freeSpace(FreeSpace& fs)	{ countFree(areas, fs); return true; }
+
 protected:
 
 	/// List of all the available free areas
-	std::list<Area *>  areas;
+	AreaList  areas;
+
+	/// Boundary tags for 'areas' (only used by the indexed eager version)
+	AreaIndex	*index;
 
 	/// For debugging this function shows the free area list
 	virtual	 void	dump();
 
 	ALiterator	  cursor;		///< remembers where we stopped searching last time
 
+	/// The areas before this one are sorted by address,
+	/// from here on they were free'd since the last reclaim.
+	ALiterator	  tailStart;
+
 	Area 	*searcher(int);		///< tries to find some room
+
+	/// Serve the requests in 'out' that are still 0 in one round from the cursor.
+	/// @returns	how many of them could be served
+	int		 batchSearcher(const int *sizes, int n, Area **out);
 	bool	reclaim();			///< tries to merge adjacent areas
 
 	virtual  void	updateStats();	///< update resource map statistics
@@ -4,20 +4,36 @@
  */
 
 #include "NextFit2.h"
+#include "AreaIndex.h"
+
+
+// The indexed version (if so requested)
+NextFit2::NextFit2(bool cflag, bool indexed)
+	: NextFit(cflag, indexed ? "NextFit (eager, indexed)" : "NextFit (eager)")
+{
+	if (indexed)
+		index = new AreaIndex;
+}
 
 
 // Iemand levert een gebied weer in
 void	NextFit2::free(Area *ap)
 {
 	require(ap != 0);
+	taken(ap);						// the sanity check (in check mode only)
+
+	if (index) {
+		mergers += index->insert(areas, ap, cursor);	// O(1) merge with both neighbours
+		return;
+	}
 
 	// Find the right place to insert ap
 	ALiterator  next = areas.end();
 	int  merged = 0;				// Counter: we merged 'ap' with some existing areas
+	int  probes = 0;				// statistics: areas looked at
 	for (ALiterator  i = areas.begin() ; i != areas.end() ;) {
 		Area  *bp = *i;					// match new ap with existing bp ...
-		if (cflag)
-			check(!ap->overlaps(bp));    // sanity check
+		++probes;
 		// Does older area bp match new free area ap?
 		if ( (bp->getBase() == (ap->getBase() + ap->getSize()))		// ap before bp ?
 		  || (ap->getBase() == (bp->getBase() + bp->getSize())) )	// bp before ap ?
@@ -40,6 +56,7 @@ void	NextFit2::free(Area *ap)
 			++merged;						// count how many "ends" we merged
 			if (merged == 2) {				// did merge both ends
 				areas.insert(next, ap);		// then insert ap before next
+				freeProbes.add(probes);
 				return;						// and leave
 			}
 			// now try to match with the other end of 'ap'
@@ -49,7 +66,32 @@ void	NextFit2::free(Area *ap)
 		}
 	}
 	// Found no further matches
+	freeProbes.add(probes);
 	areas.insert(next, ap);
 }
 
+// Return several areas at once
+void	NextFit2::freeBatch(Area **batch, int n)
+{
+	require(n >= 0);
+	if (index) {
+		Allocator::freeBatch(batch, n);			// O(1) per area already
+		return;
+	}
+	mergeBatch(areas, batch, n, cursor);		// one pass for the whole batch
+}
+
+// Nothing to reclaim when the neighbours are always merged immediately
+bool	NextFit2::reclaim()
+{
+	if (!index) {
+		// The map is not sorted at all, so sort all of it
+		// (the merge finds nothing, but the order does change)
+		tailStart = areas.begin();
+		return NextFit::reclaim();
+	}
+	++reclaims;	// update statistics
+	return false;
+}
+
 // vim:sw=4:ai:aw:ts=4:
@@ -15,6 +15,8 @@
 /// Het NextFit algorithme gebruikt het eerste
 /// gevonden bruikbare gebied in de resource map.
 /// Dit is de eager versie.
+/// De indexed versie gebruikt boundary tags (zie AreaIndex) om de buren van
+/// een teruggegeven gebied in O(1) te vinden.
 class	NextFit2 : public NextFit
 {
 public:
@@ -25,9 +27,25 @@ public:
 	NextFit2(bool cflag, const char *type = "NextFit (eager)")
 		: NextFit(cflag, type) {}
 
+	/// @param cflag	initial status of check-mode
+	/// @param indexed	use boundary tags to find the neighbours of a free'd area
+	NextFit2(bool cflag, bool indexed);
+
 	/// The application returns an area to freespace
 	/// @param ap	The area returned to free space
 	void	 free(Area *ap);	// application returns space
+
+	/// Return several areas at once, looking for their neighbours only once.
+	/// @param batch	the areas returned to free space
+	/// @param n		how many there are
+	void	 freeBatch(Area **batch, int n);
+
+protected:
+
+	/// Every area is merged when it is free'd, so there is never anything
+	/// left to reclaim. Without boundary tags the resource map is still
+	/// sorted by address, as the original NextFit did.
+	bool	 reclaim();
 };
 
 #endif	/*NextFit2_h*/
@@ -0,0 +1,637 @@
+#pragma once
+#ifndef	__PolicyFitter_h__
+#define	__PolicyFitter_h__	1.0
+
+/** @file PolicyFitter.h
+ *  @brief The list based fit family as one template: a search policy and a merge policy.
+ */
+
+#include <string>		// std::string
+#include <vector>		// std::vector
+#include "Fitter.h"
+#include "AreaIndex.h"
+
+
+// ----- search policies -----
+// Een search policy kiest het vrije gebied waar een aanvraag uit genomen
+// wordt. Elke policy heeft een 'cursor', ook als hij die zelf niet gebruikt,
+// zodat de PolicyFitter die bij het verwijderen van gebieden geldig houdt.
+// Met 'walk' kiest de PolicyFitter hoe hij een batch aanvragen in een keer
+// door de resource map zoekt (zoals FirstFit, NextFit en BestFit dat doen).
+
+/// How a search policy serves a batch (see PolicyFitter::allocBatch)
+enum	BatchWalk { FIRST_WALK, NEXT_WALK, BEST_WALK };
+
+/// @class FirstSearch
+/// Het eerste gebied in de resource map dat groot genoeg is.
+struct	FirstSearch
+{
+	static	const char	*name()	{ return "FirstFit"; }
+	static	const BatchWalk	walk = FIRST_WALK;
+
+	ALiterator	cursor;		///< not used for searching
+
+	/// @returns	the area to use, or areas.end()
+	ALiterator	find(AreaList& areas, int wanted, int& probes)
+	{
+		for (ALiterator  i = areas.begin() ; i != areas.end() ; ++i) {
+			++probes;
+			if ((*i)->getSize() >= wanted)
+				return i;
+		}
+		return areas.end();
+	}
+
+	/// The area found was removed, 'next' is the area after it
+	void	took(ALiterator)	{}
+};
+
+/// @class NextSearch
+/// Het eerste gebied dat groot genoeg is, gezocht vanaf
+/// de plek waar de vorige zoektocht eindigde.
+struct	NextSearch
+{
+	static	const char	*name()	{ return "NextFit"; }
+	static	const BatchWalk	walk = NEXT_WALK;
+
+	ALiterator	cursor;		///< where the next search starts
+
+	/// @returns	the area to use, or areas.end()
+	ALiterator	find(AreaList& areas, int wanted, int& probes)
+	{
+		for (ALiterator  i = cursor ; i != areas.end() ; ++i) {
+			++probes;
+			if ((*i)->getSize() >= wanted)
+				return i;
+		}
+		for (ALiterator  i = areas.begin() ; i != cursor ; ++i) {	// wrap around
+			++probes;
+			if ((*i)->getSize() >= wanted)
+				return i;
+		}
+		return areas.end();
+	}
+
+	/// The area found was removed, the next search starts after it
+	void	took(ALiterator next)	{ cursor = next; }
+};
+
+/// @class BestSearch
+/// Het kleinste gebied dat groot genoeg is
+/// (bij gelijke omvang het eerste in de resource map).
+struct	BestSearch
+{
+	static	const char	*name()	{ return "BestFit"; }
+	static	const BatchWalk	walk = BEST_WALK;
+
+	ALiterator	cursor;		///< not used for searching
+
+	/// @returns	the area to use, or areas.end()
+	ALiterator	find(AreaList& areas, int wanted, int& probes)
+	{
+		ALiterator  best = areas.end();
+		for (ALiterator  i = areas.begin() ; i != areas.end() ; ++i) {
+			++probes;
+			int  n = (*i)->getSize();
+			if ((n >= wanted) && ((best == areas.end()) || (n < (*best)->getSize()))) {
+				best = i;
+				if (n == wanted)
+					break;				// it does not get any better
+			}
+		}
+		return best;
+	}
+
+	/// The area found was removed, 'next' is the area after it
+	void	took(ALiterator)	{}
+};
+
+
+// ----- merge policies -----
+// Een merge policy bepaalt wanneer teruggegeven gebieden met hun buren
+// worden samengevoegd. Het zijn alleen constanten; de PolicyFitter kiest
+// daarmee tijdens het compileren welke code hij gebruikt.
+
+/// @class LazyMerge
+/// Teruggegeven gebieden komen achteraan de resource map en worden pas
+/// samengevoegd als er niets meer past (zie Fitter::coalesce).
+struct	LazyMerge
+{
+	enum { eager = false, indexed = false, sorted = false };
+	static	const char	*name()	{ return "lazy"; }
+};
+
+/// @class EagerMerge
+/// De resource map blijft op adres gesorteerd en een teruggegeven
+/// gebied wordt meteen met zijn buren samengevoegd (zoals FirstFit2).
+struct	EagerMerge
+{
+	enum { eager = true, indexed = false, sorted = true };
+	static	const char	*name()	{ return "eager"; }
+};
+
+/// @class UnsortedMerge
+/// Een teruggegeven gebied wordt meteen met zijn buren samengevoegd en
+/// neemt de plaats in van de buur waarmee het het laatst samenging; zonder
+/// vrije buren komt het achteraan (zoals NextFit2). De resource map is
+/// dus niet op adres gesorteerd; dat gebeurt (zoals bij NextFit2) pas
+/// als een aanvraag niet past.
+struct	UnsortedMerge
+{
+	enum { eager = true, indexed = false, sorted = false };
+	static	const char	*name()	{ return "eager,unsorted"; }
+};
+
+/// @class IndexedMerge
+/// Als EagerMerge, maar de buren worden in O(1) gevonden
+/// met boundary tags (zie AreaIndex).
+/// De resource map is dan niet op adres gesorteerd.
+struct	IndexedMerge
+{
+	enum { eager = true, indexed = true, sorted = false };
+	static	const char	*name()	{ return "eager,indexed"; }
+};
+
+
+/// @class PolicyFitter
+/// De fit familie met een lijst als resource map, als een template.
+/// FirstFit, NextFit en BestFit (lazy en eager) verschillen alleen in hoe
+/// ze zoeken en wanneer ze samenvoegen; hier zijn dat de 'Search' en
+/// 'Merge' policies en elke combinatie is een eigen class.
+/// Omdat alles binnen alloc en free tijdens het compileren bekend is
+/// zijn er geen virtuele aanroepen van searcher, reclaim of updateStats
+/// meer en kan de compiler de zoeklus inlinen. De code van de merge
+/// policies die niet gekozen zijn valt helemaal weg.
+/// De naam van het algoritme is b.v. "FirstFit<eager,indexed>", zodat
+/// een benchmark de template versies naast de oude laat zien.
+template<class Search, class Merge>
+class	PolicyFitter : public Fitter
+{
+public:
+
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	/// @param cflag	initial status of check-mode
+	PolicyFitter(bool cflag);
+
+	/// Cleanup free areas
+	~PolicyFitter();
+
+	void	 setSize(int new_size);	///< initialize memory size
+
+	/// Ask for an area of at least 'wanted' units.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// The application returns an area to freespace.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	/// Ask for several areas, searching the resource map only once.
+	/// @returns	how many areas were given (a failed one is 0 in 'out')
+	int		 allocBatch(const int *sizes, int n, Area **out);
+
+	/// Return several areas at once, merging them in one pass.
+	/// @param batch	the areas returned to free space
+	/// @param n		how many there are
+	void	 freeBatch(Area **batch, int n);
+
+	/// Describe the resource map (see Allocator::freeSpace)
+	bool	 freeSpace(FreeSpace& fs)	{ countFree(areas, fs); return true; }
+
+protected:
+
+	/// Search for space, and take it from the resource map
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*searcher(int wanted);
+
+	/// Merge the lazily free'd areas (the eager versions have nothing to merge,
+	/// the unsorted one is only sorted)
+	/// @returns	true if free areas could be merged
+	bool	 reclaim();
+
+private:
+
+	AreaList	areas;		///< the resource map
+	AreaIndex	index;		///< boundary tags (IndexedMerge only)
+	ALiterator	tailStart;	///< the areas free'd since the last reclaim (LazyMerge only)
+	Search		search;		///< how to find an area
+	std::string	name;		///< the name of this combination
+
+	/// Remove the area at 'i' from the resource map, keeping the cursor valid
+	/// @returns	the area after it
+	ALiterator	erase(ALiterator i);
+
+	/// Take 'wanted' from the front of the area at 'i' for a batch;
+	/// the remainder keeps its place, so other iterators stay valid.
+	/// @param ap	the area taken
+	/// @returns	true if it was used up ('i' is then the area after it)
+	bool	carve(ALiterator& i, int wanted, Area*& ap);
+
+	/// Serve the requests in 'out' that are still 0, the way 'Search' walks.
+	/// @returns	how many of them could be served
+	int		batchSearcher(const int *sizes, int n, Area **out);
+	int		batchFirst(const int *sizes, int n, Area **out);	///< as FirstFit
+	int		batchNext(const int *sizes, int n, Area **out);		///< as NextFit
+	int		batchBest(const int *sizes, int n, Area **out);		///< as BestFit
+
+	/// Put 'ap' in the sorted resource map and merge it with its neighbours
+	void	merge(Area *ap);
+
+	/// Merge 'ap' with its neighbours, without keeping the map sorted
+	void	mergeUnsorted(Area *ap);
+};
+
+
+template<class Search, class Merge>
+PolicyFitter<Search, Merge>::PolicyFitter(bool cflag)
+	: Fitter(cflag, "PolicyFitter"), tailStart(areas.end())
+	, name(std::string(Search::name()) + "<" + Merge::name() + ">")
+{
+	type = name.c_str();
+	search.cursor = areas.end();
+}
+
+// Clean up dead stuff
+template<class Search, class Merge>
+PolicyFitter<Search, Merge>::~PolicyFitter()
+{
+	while (!areas.empty()) {
+		delete areas.back();
+		areas.pop_back();
+	}
+}
+
+// Initializes how much memory we own
+template<class Search, class Merge>
+void	PolicyFitter<Search, Merge>::setSize(int new_size)
+{
+	require(areas.empty());					// prevent changing the size when the freelist is nonempty
+	Fitter::setSize(new_size);
+	areas.push_back(new Area(0, new_size));	// and create the first free area (i.e. "all")
+	search.cursor = areas.begin();
+	if (Merge::indexed) {					// and tag it
+		index.reset(new_size, areas.end());
+		index.add(areas.begin());
+	}
+}
+
+// Application wants 'wanted' memory
+template<class Search, class Merge>
+inline	Area	*PolicyFitter<Search, Merge>::alloc(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	++qcnt;									// update resource map statistics
+	qsum  += areas.size();
+	qsum2 += (areas.size() * areas.size());
+
+	// NB The qualified names make these plain (inlined) calls
+	Area  *ap = PolicyFitter::searcher(wanted);		// first attempt
+	if (!ap && PolicyFitter::reclaim())				// could we reclaim fragmented freespace ?
+		ap = PolicyFitter::searcher(wanted);		// then make a second attempt
+	return given(ap);
+}
+
+// Application returns an area no longer needed
+template<class Search, class Merge>
+inline	void	PolicyFitter<Search, Merge>::free(Area *ap)
+{
+	require(ap != 0);
+	taken(ap);				// the sanity check (in check mode only)
+	if (!Merge::eager) {
+		areas.push_back(ap);	// the lazy version
+		if (tailStart == areas.end())
+			--tailStart;		// it starts the unsorted tail
+	} else if (Merge::indexed) {
+		mergers += index.insert(areas, ap, search.cursor);	// O(1) merge with both neighbours
+	} else if (Merge::sorted) {
+		merge(ap);
+	} else {
+		mergeUnsorted(ap);
+	}
+}
+
+
+// Application wants several areas at once
+template<class Search, class Merge>
+int		PolicyFitter<Search, Merge>::allocBatch(const int *sizes, int n, Area **out)
+{
+	require(n >= 0);
+	for (int k = 0 ; k < n ; ++k) {
+		require(sizes[k] > 0);		// has to be "something",
+		require(sizes[k] <= size);	// but not more than can exist
+		out[k] = 0;
+	}
+
+	++qcnt;									// one search of the resource map
+	qsum  += areas.size();
+	qsum2 += (areas.size() * areas.size());
+
+	int  got = batchSearcher(sizes, n, out);		// first attempt
+	if ((got < n) && PolicyFitter::reclaim())		// could we reclaim fragmented freespace ?
+		got += batchSearcher(sizes, n, out);		// then make a second attempt for the rest
+	for (int k = 0 ; k < n ; ++k)
+		given(out[k]);
+	return got;
+}
+
+// Application returns several areas at once
+template<class Search, class Merge>
+void	PolicyFitter<Search, Merge>::freeBatch(Area **batch, int n)
+{
+	require(n >= 0);
+	if (!Merge::eager || Merge::indexed) {
+		Allocator::freeBatch(batch, n);			// O(1) per area already
+	} else if (Merge::sorted) {
+		// Put them all behind the sorted list,
+		// then one sort and one merge (as FirstFit2)
+		ALiterator  tail = areas.end();
+		for (int k = 0 ; k < n ; ++k) {
+			require(batch[k] != 0);
+			taken(batch[k]);					// the sanity check (in check mode only)
+			areas.push_back(batch[k]);
+			if (tail == areas.end())
+				--tail;							// the first of the batch
+		}
+		if (coalesce(areas, tail))				// NB this may have removed the cursor
+			search.cursor = areas.begin();
+		freeProbes.add(areas.size());			// statistics: one pass for the whole batch
+	} else {
+		mergeBatch(areas, batch, n, search.cursor);	// as NextFit2
+	}
+}
+
+
+// ----- internal utilities -----
+
+// Search for an area with at least 'wanted' memory
+template<class Search, class Merge>
+inline	Area	*PolicyFitter<Search, Merge>::searcher(int wanted)
+{
+	int  probes = 0;					// statistics: areas looked at
+	ALiterator  i = search.find(areas, wanted, probes);
+	searchProbes.add(probes);
+	if (i == areas.end())
+		return 0;						// report failure
+
+	Area  *ap = *i;
+	if (Merge::indexed)
+		index.remove(ap);				// no longer free
+	bool  atTail = (i == tailStart);	// NB 'erase' would invalidate 'tailStart'
+	ALiterator  next = erase(i);		// remove this element from the freelist
+	search.took(next);
+	if (ap->getSize() > wanted) {		// larger than needed ?
+		Area  *rp = ap->split(wanted);	// split into two parts (updating sizes)
+		next = areas.insert(next, rp);	// the remainder takes its place
+		if (Merge::indexed)
+			index.add(next);			// and tag the remainder
+	}
+	if (atTail)
+		tailStart = next;				// the remainder keeps its place
+	return ap;
+}
+
+// Try to join fragmented freespace
+template<class Search, class Merge>
+inline	bool	PolicyFitter<Search, Merge>::reclaim()
+{
+	++reclaims;						// update statistics
+	if (Merge::indexed || Merge::sorted)
+		return false;				// the neighbours were merged already
+	if (Merge::eager)
+		tailStart = areas.begin();	// unsorted: sort all of it (as NextFit2)
+	bool  changed = coalesce(areas, tailStart);
+	if (changed)					// iff we have changed some area's the
+		search.cursor = areas.begin();	// next search should start at the (new) front
+	return changed;
+}
+
+// Take the front of an area for a batch
+template<class Search, class Merge>
+inline	bool	PolicyFitter<Search, Merge>::carve(ALiterator& i, int wanted, Area*& ap)
+{
+	ap = *i;
+	if (Merge::indexed)
+		index.remove(ap);				// no longer free
+	if (ap->getSize() > wanted) {		// larger than needed ?
+		*i = ap->split(wanted);			// the remainder takes its place
+		if (Merge::indexed)
+			index.add(i);				// and is tagged
+		return false;
+	}
+	bool  atTail = (i == tailStart);	// NB 'erase' would invalidate 'tailStart'
+	i = erase(i);						// used up: remove it from the resource map
+	if (atTail)
+		tailStart = i;
+	return true;
+}
+
+// Search for several areas, the way the search policy walks
+template<class Search, class Merge>
+inline	int		PolicyFitter<Search, Merge>::batchSearcher(const int *sizes, int n, Area **out)
+{
+	switch (Search::walk) {
+	case NEXT_WALK:	return batchNext(sizes, n, out);
+	case BEST_WALK:	return batchBest(sizes, n, out);
+	default:		return batchFirst(sizes, n, out);
+	}
+}
+
+// One pass, each area is offered to all open requests in their order (see FirstFit)
+template<class Search, class Merge>
+int		PolicyFitter<Search, Merge>::batchFirst(const int *sizes, int n, Area **out)
+{
+	int  todo = 0;						// the open requests
+	for (int k = 0 ; k < n ; ++k) {
+		if (!out[k])
+			++todo;
+	}
+
+	int  got = 0;
+	int  probes = 0;					// statistics: areas looked at
+	for (ALiterator  i = areas.begin() ; (i != areas.end()) && (got < todo) ; ) {
+		++probes;
+		bool  gone = false;				// is this free area used up ?
+		for (int k = 0 ; (k < n) && !gone ; ++k) {
+			if (out[k] || ((*i)->getSize() < sizes[k]))
+				continue;
+			gone = carve(i, sizes[k], out[k]);
+			++got;
+		}
+		if (!gone)
+			++i;
+	}
+	searchProbes.add(probes);
+	return got;
+}
+
+// One walk from the cursor, an area serves one request (see NextFit)
+template<class Search, class Merge>
+int		PolicyFitter<Search, Merge>::batchNext(const int *sizes, int n, Area **out)
+{
+	int  todo = 0;						// the open requests
+	for (int k = 0 ; k < n ; ++k) {
+		if (!out[k])
+			++todo;
+	}
+
+	int  got = 0;
+	int  probes = 0;					// statistics: areas looked at
+	int  visits = areas.size();			// once round the resource map ...
+	ALiterator  i = search.cursor;
+	for ( ; (visits > 0) && (got < todo) ; --visits) {
+		if (i == areas.end())
+			i = areas.begin();			// wrap around
+		++probes;
+		int  k = 0;
+		while ((k < n) && (out[k] || ((*i)->getSize() < sizes[k])))
+			++k;						// the first open request that fits
+		if (k == n) {
+			++i;						// no use, move on
+			continue;
+		}
+		if (!carve(i, sizes[k], out[k]))
+			++i;
+		search.cursor = i;				// the next search starts after it
+		++got;
+		visits = areas.size() + 1;		// ... after the last serve
+	}
+	searchProbes.add(probes);
+	return got;
+}
+
+// One pass finds the best area for each request, then serve them in order (see BestFit)
+template<class Search, class Merge>
+int		PolicyFitter<Search, Merge>::batchBest(const int *sizes, int n, Area **out)
+{
+	std::vector<ALiterator>  best(n, areas.end());	// the best candidate per request
+	std::vector<bool>  lost(n, false);				// that candidate was taken by another
+	int  probes = 0;					// statistics: areas looked at
+	for (ALiterator  i = areas.begin() ; i != areas.end() ; ++i) {
+		++probes;
+		int  avail = (*i)->getSize();
+		for (int k = 0 ; k < n ; ++k) {
+			if (!out[k] && (avail >= sizes[k])
+			  && ((best[k] == areas.end()) || (avail < (*best[k])->getSize())))
+				best[k] = i;
+		}
+	}
+
+	int  got = 0;
+	for (int k = 0 ; k < n ; ++k) {
+		if (out[k])
+			continue;
+		if (lost[k])					// then search again for this one
+			best[k] = search.find(areas, sizes[k], probes);
+		ALiterator  j = best[k];
+		if (j == areas.end())			// nothing fits (the areas only get smaller)
+			continue;
+
+		ALiterator  i = j;
+		if ((*j)->getSize() == sizes[k]) {
+			for (int m = k + 1 ; m < n ; ++m) {
+				if (best[m] == j)
+					lost[m] = true;
+			}
+			carve(i, sizes[k], out[k]);	// used up
+		} else {
+			carve(i, sizes[k], out[k]);	// the remainder is still at 'j'
+			int  avail = (*j)->getSize();
+			for (int m = k + 1 ; m < n ; ++m) {
+				if (out[m] || lost[m])
+					continue;
+				if (best[m] == j)
+					lost[m] = (avail < sizes[m]);
+				else if ((avail >= sizes[m])
+				  && ((best[m] == areas.end()) || (avail < (*best[m])->getSize())))
+					best[m] = j;
+			}
+		}
+		++got;
+	}
+	searchProbes.add(probes);
+	return got;
+}
+
+// Remove an area from the resource map
+template<class Search, class Merge>
+inline	ALiterator	PolicyFitter<Search, Merge>::erase(ALiterator i)
+{
+	bool  atCursor = (i == search.cursor);	// NB 'erase' would invalidate 'cursor'
+	ALiterator  next = areas.erase(i);
+	if (atCursor)
+		search.cursor = next;
+	return next;
+}
+
+// Insert in address order and merge (the eager version)
+template<class Search, class Merge>
+void	PolicyFitter<Search, Merge>::merge(Area *ap)
+{
+	int  probes = 0;							// statistics: areas looked at
+	for (ALiterator  i = areas.begin() ; i != areas.end() ; ) {
+		Area  *bp = *i;							// match new ap with existing bp ...
+		++probes;
+		if (bp->getBase() == (ap->getBase() + ap->getSize())) {
+			// ap directly before bp: that is the last possible match
+			ALiterator  next = erase(i);		// remove bp from the list
+			ap->join(bp);						// append area bp to ap (and destroy bp)
+			++mergers;							// update statistics
+			areas.insert(next, ap);				// insert ap before next
+			freeProbes.add(probes);
+			return;
+		} else
+		if (ap->getBase() == (bp->getBase() + bp->getSize())) {
+			// ap directly after bp: bp takes over, and may match the next one too
+			i = erase(i);						// remove bp from the list
+			bp->join(ap);						// append area ap to bp (and destroy ap)
+			++mergers;							// update statistics
+			ap = bp;							// now pretend this is the free'd area
+		} else
+		if (ap->getBase() < bp->getBase()) {
+			areas.insert(i, ap);				// to keep the list sorted ap goes before bp
+			freeProbes.add(probes);
+			return;
+		} else {
+			++i;								// move on to next area in the freelist
+		}
+	}
+	freeProbes.add(probes);
+	areas.push_back(ap);						// found no match: ap goes at the end
+}
+
+// Merge with the neighbours, wherever they are (the eager, unsorted version)
+template<class Search, class Merge>
+void	PolicyFitter<Search, Merge>::mergeUnsorted(Area *ap)
+{
+	ALiterator  next = areas.end();		// where ap goes
+	int  merged = 0;					// how many neighbours we merged with
+	int  probes = 0;					// statistics: areas looked at
+	for (ALiterator  i = areas.begin() ; i != areas.end() ; ) {
+		Area  *bp = *i;					// match new ap with existing bp ...
+		++probes;
+		if ( (bp->getBase() == (ap->getBase() + ap->getSize()))		// ap before bp ?
+		  || (ap->getBase() == (bp->getBase() + bp->getSize())) )	// bp before ap ?
+		{
+			next = erase(i);			// remove bp from the list
+			if (ap->getBase() < bp->getBase()) {
+				ap->join(bp);			// append area bp to ap (and destroy bp)
+			} else {
+				bp->join(ap);			// append area ap to bp (and destroy ap)
+				ap = bp;				// and use bp as the new ap
+			}
+			++mergers;					// update statistics
+			if (++merged == 2)			// did merge both ends
+				break;
+			i = next;					// now try the other end of 'ap'
+		} else {
+			++i;						// move on to next area in the freelist
+		}
+	}
+	freeProbes.add(probes);
+	areas.insert(next, ap);
+}
+
+#endif	/*PolicyFitter_h*/
+// vim:sw=4:ai:aw:ts=4:
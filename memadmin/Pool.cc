@@ -0,0 +1,72 @@
+/** @file Pool.cc
+ * De implementatie van Pool.
+ */
+
+#include "asserts.h"	// for: require()
+#include "Pool.h"
+
+
+bool	Pool::enabled = false;		// default: use the system allocator
+long	Pool::outstanding = 0;
+
+
+// Create an (empty) pool
+Pool::Pool(size_t objsize, size_t perslab)
+	: objsize(objsize < sizeof(Link) ? sizeof(Link) : objsize)
+	, perslab(perslab), freelist(0)
+{
+	require(perslab > 0);
+	// keep every object suitably aligned for pointers
+	this->objsize = (this->objsize + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+}
+
+// Return all slabs to the system
+Pool::~Pool()
+{
+	for (size_t  i = 0 ; i < slabs.size() ; ++i) {
+		::operator delete(slabs[i]);
+	}
+}
+
+// Turn the pools on or off
+void	Pool::setEnabled(bool on)
+{
+	require(outstanding == 0);	// objects must go back where they came from
+	enabled = on;
+}
+
+// Get another slab and put all its objects on the free-list
+void	Pool::grow()
+{
+	char  *slab = static_cast<char*>(::operator new(objsize * perslab));
+	slabs.push_back(slab);
+	for (size_t  i = perslab ; i > 0 ; --i) {
+		Link  *lp = reinterpret_cast<Link*>(slab + (i - 1) * objsize);
+		lp->next = freelist;
+		freelist = lp;
+	}
+}
+
+// Hand out an object
+void	*Pool::get()
+{
+	if (!freelist)
+		grow();
+	Link  *lp = freelist;
+	freelist = lp->next;
+	++outstanding;
+	return lp;
+}
+
+// Take an object back
+void	Pool::put(void *p)
+{
+	if (!p)
+		return;
+	Link  *lp = static_cast<Link*>(p);
+	lp->next = freelist;
+	freelist = lp;
+	--outstanding;
+}
+
+// vim:sw=4:ai:aw:ts=4:
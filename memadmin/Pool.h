@@ -0,0 +1,118 @@
+#pragma once
+#ifndef	__Pool_h__
+#define	__Pool_h__	1.0
+
+/** @file Pool.h
+ *  @brief A free-list slab allocator for small fixed-size objects.
+ */
+
+#include <cstddef>		// for: size_t, ptrdiff_t
+#include <new>			// for: ::operator new()
+#include <vector>		// the STL std::vector<> container
+
+
+/// @class Pool
+/// Een "slab" allocator voor objecten van een vaste omvang.
+/// Het geheugen wordt in grote blokken (slabs) bij het systeem gehaald
+/// en teruggegeven objecten komen op een free-list voor hergebruik.
+/// Zo meten we het algoritme en niet de malloc van het systeem.
+///
+/// Alle pools samen kunnen aan of uit gezet worden; als ze uit staan
+/// gaat alles gewoon via ::operator new/delete.
+/// Omschakelen mag alleen als er geen objecten uit een pool in gebruik zijn.
+/// NB: een Pool heeft geen lock; met meerdere threads moet de
+/// aanroeper zorgen dat er maar een tegelijk bij kan (zie ThreadCache).
+class	Pool
+{
+public:
+
+	/// @param objsize	the size of the objects in this pool
+	/// @param perslab	how many objects to get from the system at once
+	explicit
+	Pool(size_t objsize, size_t perslab = 1024);
+
+	~Pool();				///< returns all slabs to the system
+
+	void	*get();			///< hand out one object
+	void	 put(void *p);	///< take an object back
+
+	/// Are the pools in use ?
+	static	bool	isEnabled()		{ return enabled; }
+
+	/// Turn all pools on or off.
+	static	void	setEnabled(bool on);
+
+private:
+
+	/// A free object is used to link the free-list
+	struct Link { Link *next; };
+
+	size_t		objsize;	///< size of the objects (at least a Link)
+	size_t		perslab;	///< number of objects per slab
+	Link		*freelist;	///< the objects available for reuse
+	std::vector<char*>	slabs;	///< what we got from the system
+
+	void	grow();			///< get another slab from the system
+
+	static	bool	enabled;		///< are the pools in use ?
+	static	long	outstanding;	///< pooled objects in use (over all pools)
+};
+
+
+/// @class PoolAllocator
+/// An STL allocator that takes single objects (e.g. the nodes of a std::list)
+/// from a Pool when the pools are enabled.
+template<class T>
+class	PoolAllocator
+{
+public:
+	typedef	size_t		size_type;
+	typedef	ptrdiff_t	difference_type;
+	typedef	T			*pointer;
+	typedef	const T		*const_pointer;
+	typedef	T			&reference;
+	typedef	const T		&const_reference;
+	typedef	T			value_type;
+
+	/// Get the allocator for another type (i.e. the list node)
+	template<class U> struct rebind { typedef PoolAllocator<U> other; };
+
+	PoolAllocator() {}
+	PoolAllocator(const PoolAllocator&) {}
+	template<class U> PoolAllocator(const PoolAllocator<U>&) {}
+
+	pointer			address(reference x) const			{ return &x; }
+	const_pointer	address(const_reference x) const	{ return &x; }
+	size_type		max_size() const	{ return size_t(-1) / sizeof(T); }
+
+	pointer	allocate(size_type n, const void * = 0)
+	{
+		if ((n == 1) && Pool::isEnabled())
+			return static_cast<pointer>(pool().get());
+		return static_cast<pointer>(::operator new(n * sizeof(T)));
+	}
+
+	void	deallocate(pointer p, size_type n)
+	{
+		if ((n == 1) && Pool::isEnabled())
+			pool().put(p);
+		else
+			::operator delete(p);
+	}
+
+	void	construct(pointer p, const T& val)	{ new(static_cast<void*>(p)) T(val); }
+	void	destroy(pointer p)					{ p->~T(); }
+
+private:
+	/// One pool for each type T
+	static	Pool&	pool()	{ static Pool  p(sizeof(T)); return p; }
+};
+
+/// All PoolAllocators are interchangeable
+template<class T, class U>
+inline	bool	operator==(const PoolAllocator<T>&, const PoolAllocator<U>&)	{ return true; }
+template<class T, class U>
+inline	bool	operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&)	{ return false; }
+
+#endif	/*Pool_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,138 @@
+/** @file QuickFit.cc
+ * De implementatie van QuickFit.
+ */
+
+#include "main.h"
+#include "QuickFit.h"
+
+
+QuickFit::QuickFit(Allocator *inner, int max, int percent, bool cflag)
+	: Wrapper(inner), max(max), percent(percent), limit(0), held(0)
+	, lists(max + 1)
+	, allocs(0), frees(0), flushes(0), oomFlushes(0)
+	, asked(max + 1), hits(max + 1)
+{
+	require(max > 0);
+	require(percent > 0 && percent <= 100);
+	this->cflag = cflag;		// NB a Wrapper does not check by itself
+}
+
+// Return what we hold before the inner allocator goes
+QuickFit::~QuickFit()
+{
+	flush();
+}
+
+
+// Initializes how much memory we own
+void	QuickFit::setSize(int new_size)
+{
+	flush();
+	Wrapper::setSize(new_size);
+	limit = int((long long)new_size * percent / 100);
+	checker.reset(new_size);
+	allocs = frees = flushes = oomFlushes = 0;
+	asked.assign(max + 1, 0);
+	hits.assign(max + 1, 0);
+}
+
+
+// Application wants 'wanted' memory
+Area	*QuickFit::alloc(int wanted)
+{
+	require(wanted > 0);
+	++allocs;
+	Area  *ap = 0;
+	if (wanted <= max) {
+		++asked[wanted];
+		std::vector<Area*>&  list = lists[wanted];
+		if (!list.empty()) {
+			++hits[wanted];
+			ap = list.back();			// the most recently free'd one
+			list.pop_back();
+			held -= wanted;
+		}
+	}
+	if (!ap) {
+		ap = inner->alloc(wanted);
+		if (!ap && held > 0) {
+			// Perhaps the quick lists are in the way
+			++oomFlushes;
+			flush();
+			ap = inner->alloc(wanted);
+		}
+	}
+	if (cflag && ap)
+		checker.given(ap);
+	return ap;
+}
+
+// Application returns an area no longer needed
+void	QuickFit::free(Area *ap)
+{
+	require(ap != 0);
+	if (cflag)
+		checker.taken(ap);				// e.g. a double free
+	++frees;
+	int  n = ap->getSize();
+	if (n > max) {
+		inner->free(ap);
+		return;
+	}
+	lists[n].push_back(ap);
+	held += n;
+	if (held > limit) {					// too much that can not merge ?
+		++flushes;
+		flush();
+	}
+}
+
+// Report statistics
+void	QuickFit::report()
+{
+	inner->report();
+	long long  h = 0, q = 0;
+	for (int n = 1 ; n <= max ; ++n) {
+		h += hits[n];
+		q += asked[n];
+	}
+	std::cout << type << ": " << allocs << " allocs, " << frees << " frees, "
+			  << h << " quick list hits (" << (allocs ? 100.0 * h / allocs : 0.0) << "% of all, "
+			  << (q ? 100.0 * h / q : 0.0) << "% of sizes upto " << max << ")\n";
+	std::cout << type << ": " << flushes << " flushes (limit " << limit << " units), "
+			  << oomFlushes << " after a failed alloc, " << held << " units held now\n";
+	for (int n = 1 ; n <= max ; ++n) {
+		if (asked[n] > 0)
+			std::cout << type << ": size " << n << ": " << asked[n] << " allocs, "
+					  << (100.0 * hits[n] / asked[n]) << "% hits\n";
+	}
+}
+
+// The quick lists are free space too (for requests of exactly that size)
+bool	QuickFit::freeSpace(FreeSpace& fs)
+{
+	if (!inner->freeSpace(fs))
+		return false;
+	for (size_t n = 1 ; n < lists.size() ; ++n) {
+		for (size_t i = 0 ; i < lists[n].size() ; ++i)
+			fs.add(int(n));
+	}
+	return true;
+}
+
+
+// ----- internal utilities -----
+
+// Give all quick lists back to the inner allocator
+void	QuickFit::flush()
+{
+	for (int n = 1 ; n <= max ; ++n) {
+		std::vector<Area*>&  list = lists[n];
+		for (size_t k = 0 ; k < list.size() ; ++k)
+			inner->free(list[k]);
+		list.clear();
+	}
+	held = 0;
+}
+
+// vim:sw=4:ai:aw:ts=4:
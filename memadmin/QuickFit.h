@@ -0,0 +1,75 @@
+#pragma once
+#ifndef	__QuickFit_h__
+#define	__QuickFit_h__	1.0
+
+/** @file QuickFit.h
+ *  @brief Exact-size quick lists in front of any Allocator.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include "Wrapper.h"
+#include "AreaChecker.h"
+
+
+/// @class QuickFit
+/// Quick lists (zoals bij QuickFit en de "fast bins" van dlmalloc) voor
+/// een willekeurige allocator. Voor elke omvang tot en met 'max' is er
+/// een LIFO lijstje van teruggegeven gebieden van precies die omvang.
+/// Een alloc van zo'n omvang wordt, als het lijstje niet leeg is, in O(1)
+/// uit het lijstje gehaald zonder de resource map van de inner allocator
+/// aan te raken. Andere aanvragen gaan gewoon door naar de inner allocator.
+/// Gebieden in de lijstjes zijn voor de inner allocator niet vrij en
+/// kunnen dus niet met hun buren samengevoegd worden. Daarom worden alle
+/// lijstjes teruggegeven ("flush") zodra ze samen meer dan 'percent'
+/// procent van het geheugen bevatten, en ook als de inner allocator
+/// een aanvraag niet kan honoreren (waarna die het nog een keer probeert).
+class	QuickFit : public Wrapper
+{
+public:
+
+	/// @param inner	the allocator that does the real work (see Wrapper)
+	/// @param max		the largest size that gets a quick list
+	/// @param percent	flush when the quick lists hold more than this part of the memory
+	/// @param cflag	initial status of check-mode
+	QuickFit(Allocator *inner, int max, int percent, bool cflag);
+
+	~QuickFit();	///< return the quick lists to the inner allocator
+
+	void	 setSize(int new_size);	///< initialize memory size
+
+	/// Ask for an area of 'wanted' units, from a quick list if possible.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// Return an area: to its quick list, or else to the inner allocator.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	bool	 freeSpace(FreeSpace& fs);	///< the free areas (see Allocator::freeSpace)
+
+	void	 report();		///< report the statistics and the hit rate
+
+private:
+
+	int		max;		///< the largest size with a quick list
+	int		percent;	///< the flush threshold, in percent of the memory
+	int		limit;		///< the flush threshold, in units
+	int		held;		///< units in the quick lists now
+
+	std::vector< std::vector<Area*> >	lists;	///< lists[n] = free areas of exactly n units
+
+	// Statistics
+	long long	allocs;		///< all allocs
+	long long	frees;		///< all frees
+	long long	flushes;	///< flushes because the lists held too much
+	long long	oomFlushes;	///< flushes because the inner allocator failed
+	std::vector<long long>	asked;	///< asked[n] = allocs of n units (n <= max)
+	std::vector<long long>	hits;	///< hits[n] = of those, served from a quick list
+
+	AreaChecker	checker;	///< the areas in use (check mode only)
+
+	void	flush();		///< return all quick lists to the inner allocator
+};
+
+#endif	/*QuickFit_h*/
+// vim:sw=4:ai:aw:ts=4:
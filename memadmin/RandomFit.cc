@@ -41,4 +41,11 @@ void	RandomFit::report()
 	std::cout << type << ": 0 reclaims with 0 mergers\n";
 }
 
+// Zonder boekhouding is al het geheugen altijd "vrij"
+bool	RandomFit::freeSpace(FreeSpace& fs)
+{
+	fs.add(size);
+	return true;
+}
+
 // vim:sw=4:ai:aw:ts=4:
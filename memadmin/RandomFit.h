@@ -39,6 +39,8 @@ public:
 	/// @param ap	The area returned to free space
 	void	 free(Area *ap);	// gebied teruggeven
 
+	bool	 freeSpace(FreeSpace& fs);	///< the free areas (see Allocator::freeSpace)
+
 	void	report();			///< report statistics (dummy)
 };
 
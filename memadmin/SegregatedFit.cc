@@ -0,0 +1,197 @@
+/** @file SegregatedFit.cc
+ * De implementatie van SegregatedFit.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include <algorithm>	// for: std::sort()
+
+#include "SegregatedFit.h"
+#include "ansi.h"
+
+
+// Clean up dead stuff
+SegregatedFit::~SegregatedFit()
+{
+	for (int k = 0 ; k < NCLASSES ; ++k) {
+		for (AreaSet::iterator  i = classes[k].begin() ; i != classes[k].end() ; ++i) {
+			delete *i;
+		}
+		classes[k].clear();
+	}
+}
+
+// Initializes how much memory we own
+void  SegregatedFit::setSize(int new_size)
+{
+	require(count == 0);					// prevent changing the size when the freelist is nonempty
+	Fitter::setSize(new_size);
+	insert(new Area(0, new_size));			// and create the first free area (i.e. "all")
+}
+
+// Print the current freelists for debugging
+void	SegregatedFit::dump()
+{
+	std::cerr << AC_BLUE << type << "::classes";
+	for (int k = 0 ; k < NCLASSES ; ++k) {
+		if (classes[k].empty())
+			continue;
+		std::cerr << " [" << k << "]";
+		for (AreaSet::iterator  i = classes[k].begin() ; i != classes[k].end() ; ++i) {
+			std::cerr << ' ' << **i;
+		}
+	}
+	std::cerr << AA_RESET << std::endl;
+}
+
+
+// Application wants 'wanted' memory
+Area  *SegregatedFit::alloc(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	updateStats();				// update resource map statistics
+
+	if (count == 0) {			// iff we have nothing
+		return 0;				// give up immediately
+	}
+
+	Area  *ap = searcher(wanted);	// first attempt
+	if (ap) {						// success ?
+		return given(ap);
+	}
+	if (reclaim()) {				// could we reclaim fragmented freespace ?
+		ap = searcher(wanted);		// then make a second attempt
+		if (ap) {					// success ?
+			return given(ap);
+		}
+	}
+	// Alas, failed to allocate anything
+	//dump();//DEBUG
+	return 0;						// inform caller we failed
+}
+
+
+// Application returns an area no longer needed
+void	SegregatedFit::free(Area *ap)
+{
+	require(ap != 0);
+	taken(ap);				// the sanity check (in check mode only)
+	insert(ap);				// the lazy version: just file it in its class
+}
+
+// All size classes together
+bool	SegregatedFit::freeSpace(FreeSpace& fs)
+{
+	for (int k = 0 ; k < NCLASSES ; ++k) {
+		for (AreaSet::iterator  i = classes[k].begin() ; i != classes[k].end() ; ++i)
+			fs.add((*i)->getSize());
+	}
+	return true;
+}
+
+
+// ----- internal utilities -----
+
+// Add a free area to the class it belongs to
+void	SegregatedFit::insert(Area *ap)
+{
+	int  k = classOf(ap->getSize());
+	classes[k].insert(ap);
+	nonempty |= (1u << k);	// class k now has something
+	++count;
+}
+
+// Remove the area at 'i' from class 'k'
+void	SegregatedFit::remove(AreaSet::iterator i, int k)
+{
+	classes[k].erase(i);
+	if (classes[k].empty())
+		nonempty &= ~(1u << k);	// class k became empty
+	--count;
+}
+
+// Search for an area with at least 'wanted' memory
+Area  *SegregatedFit::searcher(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	Area  *ap = 0;
+	int    k = classOf(wanted);
+
+	// The class of 'wanted' itself may hold areas that are too small,
+	// so that one must be searched in address order ...
+	for (AreaSet::iterator  i = classes[k].begin() ; i != classes[k].end() ; ++i) {
+		if ((*i)->getSize() >= wanted) {	// Large enough?
+			ap = *i;
+			remove(i, k);
+			break;
+		}
+	}
+	// ... but every area in a higher class is always large enough,
+	// so there we simply take the lowest address of the first nonempty class.
+	if (!ap) {
+		unsigned  higher = (k + 1 < NCLASSES) ? (nonempty & ~((2u << k) - 1)) : 0;
+		if (higher == 0) {
+			return 0;				// report failure
+		}
+		k = __builtin_ctz(higher);	// the first nonempty class above k
+		AreaSet::iterator  i = classes[k].begin();
+		ap = *i;
+		remove(i, k);
+	}
+
+	if (ap->getSize() > wanted) {		// Larger than needed ?
+		Area  *rp = ap->split(wanted);	// Split into two parts (updating sizes)
+		insert(rp);						// and file the remainder in its own class
+	}
+	return  ap;
+}
+
+
+// We have run out of usefull areas;
+// Try to reclaim space by joining fragmented freespace
+bool	SegregatedFit::reclaim()
+{
+	// Collect all free areas and sort them by address
+	std::vector<Area*>  all;
+	all.reserve(count);
+	for (int k = 0 ; k < NCLASSES ; ++k) {
+		all.insert(all.end(), classes[k].begin(), classes[k].end());
+		classes[k].clear();
+	}
+	nonempty = 0;
+	count = 0;
+	std::sort(all.begin(), all.end(), Area::orderByAddress());	// WARNING: expensive N*log(N) operation !
+
+	// Merge successive areas and file the results in their classes again
+	bool  changed = false;
+	Area  *ap = 0;					// The current candidate ...
+	for (std::vector<Area*>::iterator  i = all.begin() ; i != all.end() ; ++i) {
+		Area  *bp = *i;				// ... match it with.
+		if (ap && (bp->getBase() == (ap->getBase() + ap->getSize()))) {
+			ap->join(bp);			// append area bp to ap (and destroy bp)
+			++mergers;				// update statistics
+			changed = true;			// we changed something
+		} else {
+			if (ap)
+				insert(ap);			// ap is as large as it gets
+			ap = bp;				// move on to next free area
+		}
+	}
+	if (ap)
+		insert(ap);
+	++reclaims;	// update statistics ("reclaims attempted")
+	return changed;
+}
+
+// Update statistics
+void	SegregatedFit::updateStats()
+{
+	++qcnt;							// number of 'alloc's
+	qsum  += count;					// length of resource map
+	qsum2 += ((long long)count * count);	// same: squared
+}
+
+// vim:sw=4:ai:aw:ts=4:
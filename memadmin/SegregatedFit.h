@@ -0,0 +1,79 @@
+#pragma once
+#ifndef	__SegregatedFit_h__
+#define	__SegregatedFit_h__	1.0
+
+/** @file SegregatedFit.h
+ *  @brief The class that implements a FirstFit variant with segregated size classes.
+ */
+
+#include <set>			// the STL std::set<> container
+#include "Fitter.h"
+
+
+/// @class SegregatedFit
+/// Een FirstFit variant die de vrije gebieden niet in een lange lijst bewaart
+/// maar verdeeld over "size classes": klasse k bevat alle gebieden met een
+/// omvang van 2^k t/m 2^(k+1)-1 eenheden. Binnen een klasse blijven de gebieden
+/// gesorteerd op adres, zodat daar nog steeds "first fit" geldt.
+/// Een bitmap houdt bij welke klassen niet leeg zijn zodat we in een keer
+/// naar de eerste bruikbare klasse kunnen springen.
+/// This is the lazy version.
+class	SegregatedFit : public Fitter
+{
+public:
+
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	/// @param cflag	initial status of check-mode
+	/// @param type		name of this algorithm (default=SegregatedFit)
+	SegregatedFit(bool cflag, const char *type = "FirstFit (size classes)")
+		: Fitter(cflag, type), nonempty(0), count(0) {}
+
+	/// Cleanup free areas
+	~SegregatedFit();
+
+	void	 setSize(int new_size);	///< initialize memory size
+
+	/// Ask for an area of at least 'wanted' units.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// The application returns an area to freespace.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	bool	 freeSpace(FreeSpace& fs);	///< the free areas (see Allocator::freeSpace)
+
+protected:
+
+	/// The free areas of one size class, sorted by address
+	typedef	std::set<Area*, Area::orderByAddress, PoolAllocator<Area*> >	AreaSet;
+
+	enum { NCLASSES = 32 };		///< one class for each bit in an 'int'
+
+	AreaSet		classes[NCLASSES];	///< the free areas per size class
+	unsigned	nonempty;			///< bit k is set iff classes[k] is not empty
+	int			count;				///< the total number of free areas
+
+	/// For debugging this function shows the free area lists
+	void	dump();
+
+	/// Determine the size class of an area of 'n' units, i.e. floor(log2(n))
+	static int	classOf(int n)	{ return 31 - __builtin_clz(unsigned(n)); }
+
+	void	insert(Area *ap);		///< add a free area to its class
+	void	remove(AreaSet::iterator i, int k);	///< remove an area from class k
+
+	/// This is the actual function that searches for space.
+	/// @returns	An area or 0 if not enough freespace available
+	Area 	*searcher(int);
+
+	/// This function is called when the searcher can not find space.
+	/// It tries to reclaim fragmented space by merging adjacent free areas.
+	/// @returns true if free areas could be merged, false if no adjacent areas exist
+	bool	 reclaim();
+
+	void	 updateStats();	///< update resource map statistics
+};
+
+#endif	/*SegregatedFit_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,161 @@
+/** @file Sharded.cc
+ * De implementatie van Sharded.
+ */
+
+#include <sstream>		// std::ostringstream
+#ifdef	__linux__
+# include <sched.h>		// sched_getcpu(3)
+#endif
+#include "main.h"
+#include "Sharded.h"
+
+
+Sharded::Sharded(Allocator *first, Allocator *(*make)(bool cflag), int count, bool cflag)
+	: Allocator(cflag, "Sharded"), arenas(count), oom(0)
+{
+	require(first != 0);
+	require(count > 0);
+	std::ostringstream  os;
+	os << first->getType() << " x" << count;
+	name = os.str();
+	type = name.c_str();
+	for (int a = 0 ; a < count ; ++a) {
+		Arena&  ar = arenas[a];
+		ar.beheerder = (a == 0) ? first : make(cflag);
+		pthread_mutex_init(&ar.mutex, 0);
+		ar.base = ar.size = ar.used = ar.peak = 0;
+		ar.allocs = ar.steals = ar.fails = 0;
+	}
+}
+
+// Clean up the arenas
+Sharded::~Sharded()
+{
+	for (size_t a = 0 ; a < arenas.size() ; ++a) {
+		delete arenas[a].beheerder;
+		pthread_mutex_destroy(&arenas[a].mutex);
+	}
+}
+
+// Divide the memory over the arenas, the last one gets the remainder
+void	Sharded::setSize(int new_size)
+{
+	int  count = int(arenas.size());
+	require(new_size >= count);
+	Allocator::setSize(new_size);
+	int  each = new_size / count;
+	for (int a = 0 ; a < count ; ++a) {
+		Arena&  ar = arenas[a];
+		ar.base = a * each;
+		ar.size = (a == count - 1) ? (new_size - ar.base) : each;
+		ar.beheerder->setSize(ar.size);
+	}
+}
+
+
+// Application wants 'wanted' memory: first from our own arena, then steal
+Area	*Sharded::alloc(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	int  count = int(arenas.size());
+	int  mine = home();
+	for (int k = 0 ; k < count ; ++k) {
+		int  a = (mine + k) % count;
+		if (wanted > arenas[a].size)
+			continue;			// would not even fit in an empty arena
+		Area  *ap = take(a, wanted, k > 0);
+		if (ap)
+			return ap;
+	}
+	__sync_fetch_and_add(&oom, 1);
+	return 0;
+}
+
+// Application returns an area: it goes back to the arena it came from
+void	Sharded::free(Area *ap)
+{
+	require(ap != 0);
+	int  count = int(arenas.size());
+	int  a = ap->getBase() / arenas[0].size;
+	if (a >= count)
+		a = count - 1;			// the last one is a bit larger
+	Arena&  ar = arenas[a];
+	check(ap->getBase() >= ar.base && ap->getLast() < ar.base + ar.size);
+	pthread_mutex_lock(&ar.mutex);
+	ar.used -= ap->getSize();
+	ap->shift(-ar.base);		// back to the addresses of the arena
+	ar.beheerder->free(ap);
+	pthread_mutex_unlock(&ar.mutex);
+}
+
+// Report statistics
+void	Sharded::report()
+{
+	std::cout << type << ": " << oom << " allocs failed in all arenas\n";
+	for (size_t a = 0 ; a < arenas.size() ; ++a) {
+		Arena&  ar = arenas[a];
+		pthread_mutex_lock(&ar.mutex);
+		std::cout << type << ": arena " << a << " [" << ar.base << ".." << (ar.base + ar.size) << ")"
+				  << " utilization " << (100.0 * ar.used / ar.size) << "%"
+				  << ", peak " << (100.0 * ar.peak / ar.size) << "%"
+				  << ", " << ar.allocs << " allocs, " << ar.steals << " stolen"
+				  << ", full " << ar.fails << " times\n";
+		pthread_mutex_unlock(&ar.mutex);
+	}
+}
+
+// The free space of all arenas together
+bool	Sharded::freeSpace(FreeSpace& fs)
+{
+	bool  known = true;
+	for (size_t a = 0 ; known && (a < arenas.size()) ; ++a) {
+		Arena&  ar = arenas[a];
+		pthread_mutex_lock(&ar.mutex);
+		known = ar.beheerder->freeSpace(fs);
+		pthread_mutex_unlock(&ar.mutex);
+	}
+	return known;
+}
+
+
+// ----- internal utilities -----
+
+// The arena of the core we run on
+int		Sharded::home()
+{
+	int  count = int(arenas.size());
+	if (count == 1)
+		return 0;
+#ifdef	__linux__
+	int  cpu = sched_getcpu();
+	if (cpu >= 0)
+		return cpu % count;
+#endif
+	return 0;
+}
+
+// Try to allocate in arena 'a'
+Area	*Sharded::take(int a, int wanted, bool stolen)
+{
+	Arena&  ar = arenas[a];
+	pthread_mutex_lock(&ar.mutex);
+	Area  *ap = ar.beheerder->alloc(wanted);
+	if (ap) {
+		ap->shift(ar.base);		// to the addresses of the whole
+		ar.used += ap->getSize();
+		if (ar.used > ar.peak)
+			ar.peak = ar.used;
+		if (stolen)
+			++ar.steals;
+		else
+			++ar.allocs;
+	} else {
+		++ar.fails;
+	}
+	pthread_mutex_unlock(&ar.mutex);
+	return ap;
+}
+
+// vim:sw=4:ai:aw:ts=4:
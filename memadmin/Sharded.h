@@ -0,0 +1,81 @@
+#pragma once
+#ifndef	__Sharded_h__
+#define	__Sharded_h__	1.0
+
+/** @file Sharded.h
+ *  @brief An allocator that splits the memory into per-core arenas.
+ */
+
+#include <string>		// std::string
+#include <vector>		// the STL std::vector<> container
+#include <pthread.h>	// pthread_mutex_t
+#include "Allocator.h"
+
+
+/// @class Sharded
+/// Verdeelt het geheugen in K even grote arena's, elk met een eigen
+/// allocator (van hetzelfde algoritme) en een eigen mutex.
+/// Een thread vraagt geheugen aan de arena van de core waar hij op
+/// draait, dus threads op verschillende cores zitten elkaar niet in de weg.
+/// Is die arena vol dan wordt er bij de andere arena's "gestolen"
+/// voordat we opgeven. Een free gaat op grond van het adres terug
+/// naar de arena waar het gebied vandaan kwam.
+/// Elke arena beheert de adressen 0 .. omvang, Sharded verschuift
+/// de gebieden naar hun plaats in het geheel (zie Area::shift).
+/// NB: een gebied kan nooit groter zijn dan een arena.
+/// NB: de arena's maken en verwijderen hun Area's en lijst nodes via de
+/// globale Pool (zie -P), en die heeft geen lock. Met de pools aan is
+/// Sharded dus alleen veilig onder de lock van een ThreadCache.
+class	Sharded : public Allocator
+{
+public:
+
+	/// @param first	the allocator for arena 0 (is deleted by us)
+	/// @param make		makes the allocators for the other arenas (see Factory)
+	/// @param count	the number of arenas
+	/// @param cflag	initial status of check-mode
+	Sharded(Allocator *first, Allocator *(*make)(bool cflag), int count, bool cflag);
+
+	~Sharded();			///< cleanup the arenas
+
+	void	 setSize(int new_size);	///< divide the memory over the arenas
+
+	/// Ask for an area of 'wanted' units; may be called by any thread
+	/// (provided the pools are off, see above).
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// Return an area to its arena; may be called by any thread
+	/// (provided the pools are off, see above).
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	bool	 freeSpace(FreeSpace& fs);	///< the free areas (see Allocator::freeSpace)
+
+	void	 report();		///< report utilization and steals per arena
+
+private:
+
+	/// One arena
+	struct	Arena {
+		Allocator		*beheerder;	///< the algorithm
+		pthread_mutex_t	 mutex;		///< protects all of this arena
+		int				 base;		///< the first unit of this arena
+		int				 size;		///< its size
+		int				 used;		///< units given out
+		int				 peak;		///< the most units given out
+		long long		 allocs;	///< allocs for its own core
+		long long		 steals;	///< allocs for another core
+		long long		 fails;		///< it was full
+	};
+
+	std::string			name;		///< our type: e.g. "FirstFit (lazy) x4"
+	std::vector<Arena>	arenas;
+	long long			oom;		///< no arena had room
+
+	int		home();					///< the arena of the calling thread
+	Area	*take(int a, int wanted, bool stolen);	///< try one arena
+};
+
+#endif	/*Sharded_h*/
+// vim:sw=4:ai:aw:ts=4:
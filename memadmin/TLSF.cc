@@ -0,0 +1,218 @@
+/** @file TLSF.cc
+ * De implementatie van TLSF.
+ */
+
+#include "TLSF.h"
+#include "ansi.h"
+
+
+TLSF::TLSF(bool cflag, const char *type)
+	: Fitter(cflag, type), flmap(0), count(0)
+{
+	for (int f = 0 ; f < FLCOUNT ; ++f) {
+		slmap[f] = 0;
+		for (int s = 0 ; s < SLCOUNT ; ++s)
+			heads[f][s] = -1;
+	}
+}
+
+// Initializes how much memory we own
+void  TLSF::setSize(int new_size)
+{
+	require(count == 0);				// prevent changing the size when the free-lists are nonempty
+	Fitter::setSize(new_size);
+	sizeAt.assign(new_size, 0);
+	startOf.assign(new_size, -1);
+	next.assign(new_size, -1);
+	prev.assign(new_size, -1);
+	insert(0, new_size);				// and create the first free area (i.e. "all")
+}
+
+// Print the free-lists for debugging
+void	TLSF::dump()
+{
+	std::cerr << AC_BLUE << type << "::free";
+	for (int f = 0 ; f < FLCOUNT ; ++f) {
+		for (int s = 0 ; s < SLCOUNT ; ++s) {
+			if (heads[f][s] < 0)
+				continue;
+			std::cerr << " [" << f << ',' << s << "]";
+			for (int b = heads[f][s] ; b >= 0 ; b = next[b]) {
+				std::cerr << ' ' << b << ':' << sizeAt[b];
+			}
+		}
+	}
+	std::cerr << AA_RESET << std::endl;
+}
+
+
+// Application wants 'wanted' memory
+Area  *TLSF::alloc(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	updateStats();				// update resource map statistics
+
+	Area  *ap = searcher(wanted);
+	if (!ap) {
+		reclaim();				// only for the statistics
+	}
+	return given(ap);			// the area, or 0 if we failed
+}
+
+
+// Application returns an area no longer needed
+void	TLSF::free(Area *ap)
+{
+	require(ap != 0);
+	taken(ap);					// the sanity check (in check mode only)
+	int  b = ap->getBase();
+	int  n = ap->getSize();
+	delete ap;
+
+	// Merge with the free area after us ...
+	if ((b + n < size) && (sizeAt[b + n] > 0)) {
+		int  m = sizeAt[b + n];
+		remove(b + n);
+		n += m;
+		++mergers;						// update statistics
+	}
+	// ... and with the free area before us
+	if ((b > 0) && (startOf[b - 1] >= 0)) {
+		int  p = startOf[b - 1];
+		n += sizeAt[p];
+		remove(p);
+		b = p;
+		++mergers;						// update statistics
+	}
+	insert(b, n);
+}
+
+// All free-lists; an allocated area is never rounded up
+bool	TLSF::freeSpace(FreeSpace& fs)
+{
+	for (int f = 0 ; f < FLCOUNT ; ++f) {
+		for (int s = 0 ; s < SLCOUNT ; ++s) {
+			for (int b = heads[f][s] ; b >= 0 ; b = next[b])
+				fs.add(sizeAt[b]);
+		}
+	}
+	return true;
+}
+
+
+// ----- internal utilities -----
+
+// Which list holds free areas of 'n' units:
+// below SLCOUNT each size has its own list (fl=0),
+// above that the highest bit gives 'fl' and the next SLBITS bits give 'sl'.
+void	TLSF::mapping(int n, int& fl, int& sl)
+{
+	if (n < SLCOUNT) {
+		fl = 0;
+		sl = n;
+	} else {
+		int  msb = 31 - __builtin_clz(unsigned(n));
+		fl = msb - SLBITS + 1;
+		sl = (n >> (msb - SLBITS)) - SLCOUNT;
+	}
+}
+
+// Put area b..b+n-1 in the right free-list and set its boundary tags
+void	TLSF::insert(int b, int n)
+{
+	int  fl, sl;
+	mapping(n, fl, sl);
+	sizeAt[b] = n;
+	startOf[b + n - 1] = b;
+	prev[b] = -1;
+	next[b] = heads[fl][sl];
+	if (heads[fl][sl] >= 0)
+		prev[heads[fl][sl]] = b;
+	heads[fl][sl] = b;
+	slmap[fl] |= (1u << sl);
+	flmap |= (1u << fl);
+	++count;
+}
+
+// Remove the free area at b from its free-list and clear its boundary tags
+void	TLSF::remove(int b)
+{
+	int  n = sizeAt[b];
+	int  fl, sl;
+	mapping(n, fl, sl);
+	if (prev[b] >= 0)
+		next[prev[b]] = next[b];
+	else
+		heads[fl][sl] = next[b];
+	if (next[b] >= 0)
+		prev[next[b]] = prev[b];
+	if (heads[fl][sl] < 0) {
+		slmap[fl] &= ~(1u << sl);
+		if (slmap[fl] == 0)
+			flmap &= ~(1u << fl);
+	}
+	sizeAt[b] = 0;
+	startOf[b + n - 1] = -1;
+	--count;
+}
+
+// Find an area for 'wanted' units in constant time
+Area  *TLSF::searcher(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	// Round up to the next list, so that any area in it will do
+	unsigned  n = wanted;
+	if (n >= unsigned(SLCOUNT))
+		n += (1u << (31 - __builtin_clz(n) - SLBITS)) - 1;
+	if (n >= (1u << 31))
+		n = (1u << 31) - 1;		// beyond the largest list
+	int  fl, sl;
+	mapping(int(n), fl, sl);
+
+	// First look for a list in the same first level ...
+	unsigned  avail = slmap[fl] & (~0u << sl);
+	if (avail == 0) {
+		// ... otherwise in the next nonempty first level
+		unsigned  higher = (fl + 1 < FLCOUNT) ? (flmap & (~0u << (fl + 1))) : 0;
+		if (higher != 0) {
+			fl = __builtin_ctz(higher);
+			avail = slmap[fl];
+		}
+	}
+	if (avail == 0) {
+		// Nothing guaranteed to fit. The list for 'wanted' itself may
+		// still hold a large enough area, but searching it is not O(1),
+		// so (like the original TLSF) we give up.
+		return 0;				// report failure
+	}
+	sl = __builtin_ctz(avail);
+	int  b = heads[fl][sl];
+
+	int  got = sizeAt[b];
+	remove(b);
+	if (got > wanted) {			// put the rest back
+		insert(b + wanted, got - wanted);
+	}
+	return new Area(b, wanted);
+}
+
+// Areas are always merged immediately
+bool	TLSF::reclaim()
+{
+	++reclaims;	// update statistics ("reclaims attempted")
+	return false;
+}
+
+// Update statistics
+void	TLSF::updateStats()
+{
+	++qcnt;									// number of 'alloc's
+	qsum  += count;							// number of free areas
+	qsum2 += ((long long)count * count);	// same: squared
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef	__TLSF_h__
+#define	__TLSF_h__	1.0
+
+/** @file TLSF.h
+ *  @brief The class that implements the "Two-Level Segregated Fit" algorithm.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include "Fitter.h"
+
+
+/// @class TLSF
+/// Het TLSF algoritme (Masmano e.a.), een "good fit" in O(1).
+/// De vrije gebieden staan in free-lists per omvang: het eerste niveau
+/// is de hoogste bit van de omvang, het tweede niveau verdeelt zo'n
+/// macht van twee nog eens in 2^SLBITS stukken. Twee niveaus bitmaps
+/// vertellen welke lijsten niet leeg zijn zodat een geschikte lijst met
+/// een "find first set" gevonden wordt, zonder zoeken.
+/// Bij de aanvraag wordt de omvang naar boven afgerond op de volgende
+/// lijst, zodat het eerste gebied daarin altijd groot genoeg is; zit er
+/// niets in de lijsten daarboven, dan faalt de aanvraag (ook als een lijst
+/// daaronder toevallig een groot genoeg gebied heeft). Zo wordt er nooit
+/// gezocht en is ook de slechtste tijd O(1).
+/// Met "boundary tags" (per begin- en eindadres) worden vrijgegeven
+/// gebieden meteen in O(1) met hun buren samengevoegd.
+/// De latency van alloc en free meet je met -L (zie LatencyProfiler).
+class	TLSF : public Fitter
+{
+public:
+
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	/// @param cflag	initial status of check-mode
+	/// @param type		name of this algorithm (default=TLSF)
+	TLSF(bool cflag, const char *type = "TLSF");
+
+	void	 setSize(int new_size);	///< initialize memory size
+
+	/// Ask for an area of at least 'wanted' units.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// The application returns an area to freespace.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	bool	 freeSpace(FreeSpace& fs);	///< the free areas (see Allocator::freeSpace)
+
+protected:
+
+	enum {
+		SLBITS = 4,						///< log2 of the number of second level lists
+		SLCOUNT = (1 << SLBITS),		///< second level lists per first level
+		FLCOUNT = 32 - SLBITS			///< first level lists (sizes < 2^31)
+	};
+
+	std::vector<int>	sizeAt;	///< sizeAt[b] = size of the free area starting at b, or 0
+	std::vector<int>	startOf;///< startOf[l] = begin of the free area ending at l, or -1
+	std::vector<int>	next;	///< the free-lists: next[b] = next free area in the same list
+	std::vector<int>	prev;	///< and prev[b] the previous one (or -1)
+	int			heads[FLCOUNT][SLCOUNT];	///< the first free area of each list (or -1)
+	unsigned	flmap;					///< bit f is set iff slmap[f] != 0
+	unsigned	slmap[FLCOUNT];			///< bit s is set iff heads[f][s] is nonempty
+	int			count;					///< the number of free areas
+
+	/// The list that holds free areas of 'n' units
+	static void	mapping(int n, int& fl, int& sl);
+
+	void	insert(int b, int n);	///< put area b..b+n-1 in the right free-list
+	void	remove(int b);			///< remove the free area at b from its free-list
+
+	/// For debugging this function shows the free-lists
+	void	dump();
+
+	/// This is the actual function that searches for space.
+	/// @returns	An area or 0 if not enough freespace available
+	Area 	*searcher(int);
+
+	/// Areas are merged as soon as they are free'd.
+	/// @returns false
+	bool	 reclaim();
+
+	void	 updateStats();	///< update resource map statistics
+};
+
+#endif	/*TLSF_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,204 @@
+/** @file ThreadCache.cc
+ * De implementatie van ThreadCache.
+ */
+
+#include <errno.h>		// EBUSY
+#include <algorithm>	// std::find
+#include "main.h"
+#include "ThreadCache.h"
+#include "unix_error.h"
+
+
+ThreadCache::Cache::Cache(ThreadCache *owner)
+	: owner(owner), bins(MAXCACHED + 1)
+	, allocs(0), hits(0), frees(0), refills(0), flushes(0)
+{
+}
+
+
+ThreadCache::ThreadCache(Allocator *inner, bool cached, bool serialize)
+	: Wrapper(inner), cached(cached), serialize(serialize)
+	, allocs(0), hits(0), frees(0), refills(0), flushes(0)
+	, locks(0), contended(0)
+{
+	int  err = pthread_key_create(&key, threadGone);
+	if (err) {
+		errno = err;
+		throw unix_error("pthread_key_create");
+	}
+	pthread_mutex_init(&mutex, 0);
+}
+
+// The threads should be gone, but the calling thread may still have a cache
+ThreadCache::~ThreadCache()
+{
+	{
+		Guard  g(this);
+		while (!caches.empty())
+			retire(caches.back());
+	}
+	pthread_key_delete(key);
+	pthread_mutex_destroy(&mutex);
+}
+
+
+// Application wants 'wanted' memory
+Area	*ThreadCache::alloc(int wanted)
+{
+	Cache  *cp = mine();
+	++cp->allocs;
+	if (cached && wanted <= MAXCACHED) {
+		std::vector<Area*>&  bin = cp->bins[wanted];
+		if (bin.empty()) {
+			// Get a batch of them at once
+			Guard  g(this, serialize);
+			++cp->refills;
+			for (int k = 0 ; k < BATCH ; ++k) {
+				Area  *ap = inner->alloc(wanted);
+				if (!ap)
+					break;
+				if (ap->getSize() != wanted)	// e.g. a buddy system rounds up,
+					return ap;					// those are not cached
+				bin.push_back(ap);
+			}
+		} else {
+			++cp->hits;
+		}
+		if (!bin.empty()) {
+			Area  *ap = bin.back();
+			bin.pop_back();
+			return ap;
+		}
+	}
+
+	Guard  g(this, serialize);
+	Area  *ap = inner->alloc(wanted);
+	if (!ap && cached) {
+		// Perhaps our own cache is in the way
+		for (int n = 1 ; n <= MAXCACHED ; ++n)
+			drain(cp, n, int(cp->bins[n].size()));
+		ap = inner->alloc(wanted);
+	}
+	return ap;
+}
+
+// Application returns an area no longer needed
+void	ThreadCache::free(Area *ap)
+{
+	require(ap != 0);
+	Cache  *cp = mine();
+	++cp->frees;
+	int  n = ap->getSize();
+	if (cached && n <= MAXCACHED) {
+		cp->bins[n].push_back(ap);
+		if (cp->bins[n].size() > 2 * BATCH) {	// too many of them ?
+			Guard  g(this, serialize);
+			drain(cp, n, BATCH);
+		}
+		return;
+	}
+	Guard  g(this, serialize);
+	inner->free(ap);
+}
+
+// Report statistics
+void	ThreadCache::report()
+{
+	inner->report();
+	long long  a, h, f, r, d, l, c;
+	{
+		Guard  g(this);
+		a = allocs, h = hits, f = frees, r = refills, d = flushes;
+		for (size_t i = 0 ; i < caches.size() ; ++i) {
+			a += caches[i]->allocs;
+			h += caches[i]->hits;
+			f += caches[i]->frees;
+			r += caches[i]->refills;
+			d += caches[i]->flushes;
+		}
+		l = locks, c = contended;
+	}
+	std::cout << type << ": " << a << " allocs, " << f << " frees";
+	if (cached)
+		std::cout << ", " << h << " cache hits (" << (a ? 100.0 * h / a : 0.0) << "%), "
+				  << r << " refills, " << d << " flushes";
+	std::cout << '\n';
+	std::cout << type << ": " << l << " locks, " << c << " contended ("
+			  << (l ? 100.0 * c / l : 0.0) << "%)\n";
+}
+
+// Forget the statistics
+void	ThreadCache::clearStats()
+{
+	Guard  g(this);
+	allocs = hits = frees = refills = flushes = 0;
+	for (size_t i = 0 ; i < caches.size() ; ++i) {
+		Cache  *cp = caches[i];
+		cp->allocs = cp->hits = cp->frees = cp->refills = cp->flushes = 0;
+	}
+	locks = contended = 0;
+}
+
+
+// ----- internal utilities -----
+
+// The cache of the calling thread, made on first use
+ThreadCache::Cache	*ThreadCache::mine()
+{
+	Cache  *cp = static_cast<Cache*>(pthread_getspecific(key));
+	if (!cp) {
+		cp = new Cache(this);
+		pthread_setspecific(key, cp);
+		Guard  g(this);
+		caches.push_back(cp);
+	}
+	return cp;
+}
+
+// Take the mutex, counting how often somebody else had it
+void	ThreadCache::lock()
+{
+	if (pthread_mutex_trylock(&mutex) == EBUSY) {
+		pthread_mutex_lock(&mutex);
+		++contended;
+	}
+	++locks;
+}
+
+// Give 'count' areas of bin n back to the inner allocator (mutex taken)
+void	ThreadCache::drain(Cache *cp, int n, int count)
+{
+	std::vector<Area*>&  bin = cp->bins[n];
+	if (count == 0 || bin.empty())
+		return;
+	++cp->flushes;
+	for (int k = 0 ; k < count && !bin.empty() ; ++k) {
+		inner->free(bin.back());
+		bin.pop_back();
+	}
+}
+
+// A thread is gone: return its areas and keep its statistics (mutex taken)
+void	ThreadCache::retire(Cache *cp)
+{
+	for (int n = 1 ; n <= MAXCACHED ; ++n)
+		drain(cp, n, int(cp->bins[n].size()));
+	allocs += cp->allocs;
+	hits += cp->hits;
+	frees += cp->frees;
+	refills += cp->refills;
+	flushes += cp->flushes;
+	caches.erase(std::find(caches.begin(), caches.end(), cp));
+	delete cp;
+}
+
+// Called by pthreads when a thread with a cache exits
+void	ThreadCache::threadGone(void *p)
+{
+	Cache  *cp = static_cast<Cache*>(p);
+	ThreadCache  *tc = cp->owner;
+	Guard  g(tc);
+	tc->retire(cp);
+}
+
+// vim:sw=4:ai:aw:ts=4:
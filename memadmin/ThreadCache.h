@@ -0,0 +1,111 @@
+#pragma once
+#ifndef	__ThreadCache_h__
+#define	__ThreadCache_h__	1.0
+
+/** @file ThreadCache.h
+ *  @brief A thread-caching front end (a la tcmalloc) for any Allocator.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include <pthread.h>	// pthread_mutex_t, pthread_key_t
+#include "Wrapper.h"
+
+
+/// @class ThreadCache
+/// Maakt van elke allocator een allocator die door meerdere threads
+/// tegelijk gebruikt mag worden, zoals tcmalloc dat doet.
+/// Elke thread heeft een eigen cache met per omvang (tot MAXCACHED)
+/// een lijstje recent vrijgegeven gebieden. Een alloc die uit de cache
+/// kan komen heeft geen lock nodig. Is de cache leeg, dan worden er
+/// in een keer BATCH gebieden van die omvang bij de inner allocator
+/// gehaald; wordt een lijstje te lang dan gaan er BATCH terug.
+/// Alle aanroepen van de inner allocator gebeuren onder een mutex,
+/// dus de inner allocator (en de Pool van de Area's) hoeft niet
+/// thread-safe te zijn. Is hij dat wel (de Sharded zelf, zonder pools
+/// en zonder andere wrappers ertussen) dan kan die mutex weg
+/// ('serialize' is false).
+/// Zonder cache ('cached' is false) gaat alles onder de mutex naar de
+/// inner allocator: het model van een globale free-list met een lock.
+/// NB: met de caches ziet de inner allocator (en elke wrapper daarin)
+/// alleen de refills en flushes, niet de allocs en frees zelf.
+/// NB: een gebied in de cache van de ene thread is niet beschikbaar
+/// voor een andere thread; faalt de inner allocator dan wordt alleen
+/// de eigen cache geleegd en nog een keer geprobeerd.
+class	ThreadCache : public Wrapper
+{
+public:
+
+	/// @param inner	the allocator that does the real work (see Wrapper)
+	/// @param cached	use the per-thread caches, or only the lock
+	/// @param serialize	lock around the inner allocator (false if it is thread-safe)
+	ThreadCache(Allocator *inner, bool cached = true, bool serialize = true);
+
+	~ThreadCache();		///< return the cached areas to the inner allocator
+
+	/// Ask for an area of 'wanted' units; may be called by any thread.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// Return an area; may be called by any thread.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	void	 report();		///< report the statistics of the inner allocator and the caches
+
+	/// Forget the statistics, e.g. before the next run
+	void	 clearStats();
+
+	long long	getLocks() const		{ return locks; }		///< lock acquisitions
+	long long	getContended() const	{ return contended; }	///< lock was already taken
+
+private:
+
+	enum {
+		MAXCACHED = 256,	///< larger areas are not cached
+		BATCH = 32			///< areas per refill or flush
+	};
+
+	/// The private cache of one thread
+	struct	Cache {
+		ThreadCache	*owner;
+		std::vector< std::vector<Area*> >	bins;	///< bins[n] = free areas of n units
+		long long	allocs, hits, frees;			///< statistics (no lock needed)
+		long long	refills, flushes;
+		Cache(ThreadCache *owner);
+	};
+
+	bool				cached;		///< use the caches ?
+	bool				serialize;	///< lock around the inner allocator ?
+	pthread_key_t		key;		///< to find the cache of a thread
+	pthread_mutex_t		mutex;		///< protects the inner allocator and all below
+	std::vector<Cache*>	caches;		///< the caches of the living threads
+
+	// Statistics, of the threads that are gone and of the lock
+	long long	allocs, hits, frees, refills, flushes;
+	long long	locks, contended;
+
+	/// Holds the mutex while it exists, also when an exception passes
+	class	Guard {
+	public:
+		/// @param take	false: do not lock at all (see 'serialize')
+		Guard(ThreadCache *tc, bool take = true) : tc(take ? tc : 0)	{ if (this->tc) this->tc->lock(); }
+		~Guard()	{ if (tc) tc->unlock(); }
+	private:
+		ThreadCache	*tc;			///< the one to unlock, or 0
+		Guard(const Guard&);		// not copyable
+		void	operator=(const Guard&);
+	};
+	friend class Guard;
+
+	Cache	*mine();					///< the cache of the calling thread
+	void	 lock();					///< take the mutex (and count contention)
+	void	 unlock()	{ pthread_mutex_unlock(&mutex); }
+
+	void	 drain(Cache *cp, int n, int count);	///< give back 'count' areas of bin n (locked)
+	void	 retire(Cache *cp);			///< a thread is gone: drain and forget its cache
+
+	static	void	threadGone(void *cp);	///< the pthread key destructor
+};
+
+#endif	/*ThreadCache_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,123 @@
+/** @file ThreadedApplication.cc
+ * De implementatie van ThreadedApplication.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include <stdexcept>	// std::runtime_error
+#include <errno.h>		// errno
+#include "main.h"
+#include "ThreadedApplication.h"
+#include "Histogram.h"	// nanotime()
+#include "unix_error.h"
+
+
+ThreadedApplication::ThreadedApplication(ThreadCache *beheerder, int size)
+	: beheerder(beheerder), size(size), oom(0)
+{
+	require(beheerder != 0);
+	require(size > 0);
+}
+
+
+// Let 'threads' threads do the work together
+double	ThreadedApplication::run(int threads, int aantal)
+{
+	require(threads > 0);
+	std::vector<Worker>     work(threads);
+	std::vector<pthread_t>  tids(threads);
+
+	// Together they use at most half of the memory
+	size_t  limit = size / (threads * 2 * MAXAREA);
+	if (limit < 1)
+		limit = 1;
+
+	long long  t0 = nanotime();
+	for (int t = 0 ; t < threads ; ++t) {
+		work[t].app = this;
+		work[t].seed = 2463534242u + 7919u * t;
+		work[t].ops = aantal / threads;
+		work[t].limit = limit;
+		work[t].oom = 0;
+		work[t].error.clear();
+		int  err = pthread_create(&tids[t], 0, worker, &work[t]);
+		if (err) {
+			errno = err;
+			throw unix_error("pthread_create");
+		}
+	}
+	for (int t = 0 ; t < threads ; ++t)
+		pthread_join(tids[t], 0);
+	long long  t1 = nanotime();
+	oom = 0;
+	for (int t = 0 ; t < threads ; ++t) {
+		if (!work[t].error.empty())
+			throw std::runtime_error(work[t].error);
+		oom += work[t].oom;
+	}
+	return (t1 - t0) / 1e9;
+}
+
+// Measure the throughput with more and more threads
+void	ThreadedApplication::scaling(int maxthreads, int aantal)
+{
+	std::cout << "threads,seconds,Mops_per_s,speedup,oom,locks,contended\n";
+	double  base = 0;
+	for (int t = 1 ; t <= maxthreads ; ++t) {
+		beheerder->clearStats();
+		double  secs = run(t, aantal);
+		double  mops = (secs > 0) ? (aantal / t * t) / secs / 1e6 : 0.0;
+		if (t == 1)
+			base = mops;
+		std::cout << t << ',' << secs << ',' << mops << ','
+				  << (base > 0 ? mops / base : 0.0) << ',' << oom << ','
+				  << beheerder->getLocks() << ',' << beheerder->getContended() << '\n';
+	}
+}
+
+
+// ----- internal utilities -----
+
+// The body of a thread: random allocs and frees.
+// NB an exception may not leave a thread, so it is kept for 'run'.
+void	*ThreadedApplication::worker(void *wp)
+{
+	Worker&  w = *static_cast<Worker*>(wp);
+	try {
+		work(w);
+	} catch (const std::exception& e) {
+		w.error = e.what();
+	} catch (...) {
+		w.error = "unknown exception in a thread";
+	}
+	return 0;
+}
+
+// The random allocs and frees of one thread
+void	ThreadedApplication::work(Worker& w)
+{
+	ThreadCache  *beheerder = w.app->beheerder;
+	std::vector<Area*>  live;
+	live.reserve(w.limit);
+	unsigned  x = w.seed;
+	for (int i = 0 ; i < w.ops ; ++i) {
+		x ^= x << 13;		// xorshift: rand(3) is not thread-safe
+		x ^= x >> 17;
+		x ^= x << 5;
+		if (live.size() < w.limit && (live.empty() || (x & 1))) {
+			Area  *ap = beheerder->alloc(1 + (x >> 8) % MAXAREA);
+			if (ap)
+				live.push_back(ap);
+			else
+				++w.oom;
+		} else {
+			size_t  k = (x >> 16) % live.size();
+			beheerder->free(live[k]);
+			live[k] = live.back();
+			live.pop_back();
+		}
+	}
+	for (size_t k = 0 ; k < live.size() ; ++k)
+		beheerder->free(live[k]);
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,62 @@
+#pragma once
+#ifndef	__ThreadedApplication_h__
+#define	__ThreadedApplication_h__	1.0
+
+/** @file ThreadedApplication.h
+ *  @brief A fake application with several threads that allocate at the same time.
+ */
+
+#include <string>		// std::string
+#include "ThreadCache.h"
+
+
+/// @class ThreadedApplication
+/// Een namaak applicatie met N threads die tegelijk geheugen vragen
+/// en weer vrijgeven via een ThreadCache. Elke thread doet zijn deel van
+/// het werk met een eigen random generator en een eigen lijst gebieden,
+/// zodat alleen de allocator gedeeld wordt.
+/// 'scaling' meet de doorvoer met 1, 2, ... N threads; zo is te zien
+/// hoeveel de lock op de gedeelde allocator kost en wat de caches winnen.
+class	ThreadedApplication
+{
+public:
+
+	/// @param beheerder	the (thread-safe) allocator to use
+	/// @param size			the amount of memory it manages
+	ThreadedApplication(ThreadCache *beheerder, int size);
+
+	/// Let 'threads' threads together do 'aantal' allocs and frees.
+	/// An exception in a thread (e.g. a failed check) stops that thread;
+	/// when they are all done it is thrown again as a std::runtime_error.
+	/// @returns	the elapsed (wall clock) time in seconds
+	double	run(int threads, int aantal);
+
+	int		getOOM() const	{ return oom; }	///< failed allocs in the last run
+
+	/// Do 'run' with 1 upto 'maxthreads' threads and print the throughput.
+	void	scaling(int maxthreads, int aantal);
+
+private:
+
+	/// The work of one thread
+	struct	Worker {
+		ThreadedApplication	*app;
+		unsigned	seed;		///< for the random generator
+		int			ops;		///< allocs and frees to do
+		size_t		limit;		///< at most this many areas in use
+		int			oom;		///< failed allocs
+		std::string	error;		///< why the thread stopped early (e.g. a failed check)
+	};
+
+	enum { MAXAREA = 32 };		///< areas of 1 .. MAXAREA units
+
+	ThreadCache	*beheerder;
+	int			 size;
+	int			 oom;		///< failed allocs in the last run
+
+	static	void	*worker(void *wp);	///< the body of a thread
+	static	void	 work(Worker& w);	///< the allocs and frees of a thread
+};
+
+#endif	/*ThreadedApplication_h*/
+// vim:sw=4:ai:aw:ts=4:
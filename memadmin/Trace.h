@@ -0,0 +1,76 @@
+#pragma once
+#ifndef	__Trace_h__
+#define	__Trace_h__	1.0
+
+/** @file Trace.h
+ *  @brief The binary format of an alloc/free trace.
+ *
+ *  A trace file is one TraceHeader followed by 'count' TraceRecords,
+ *  both in the native byte order of the machine that wrote them.
+ *  Objects are identified by a small number ("id") that is reused
+ *  after the object is free'd, so a replay can keep its live objects
+ *  in a plain array of 'maxid+1' entries.
+ *  See: TraceRecorder (writes a trace) and TraceReplay (reads one).
+ *  Traces of real programs are made with preload/memtrace.cc and
+ *  converted with TraceConverter.
+ */
+
+#include <stdint.h>		// uint32_t, uint64_t
+
+
+/// The kind of a trace record
+enum	TraceOp {
+	TRACE_ALLOC = 0,	///< alloc(size) returned object 'id'
+	TRACE_FREE  = 1,	///< free(object 'id')
+	TRACE_FAIL  = 2		///< alloc(size) failed (id is not used)
+};
+
+/// The first bytes of a trace file
+struct	TraceHeader {
+	char		magic[4];	///< always "MATR"
+	uint32_t	version;	///< format version (1)
+	uint32_t	size;		///< memory size (units) when it was recorded
+	uint32_t	maxid;		///< the largest object id in the trace
+	uint64_t	count;		///< the number of records
+};
+
+/// One alloc or free (16 bytes)
+struct	TraceRecord {
+	uint64_t	time;		///< nanoseconds since the start of the recording
+	uint32_t	id;			///< the object
+	uint32_t	sizeop;		///< (size << 2) | TraceOp
+
+	TraceOp		getOp() const	{ return TraceOp(sizeop & 3); }
+	int			getSize() const	{ return int(sizeop >> 2); }
+};
+
+#define	TRACE_MAGIC		"MATR"
+#define	TRACE_VERSION	1
+
+
+// ----- the raw traces of a real program -----
+// preload/memtrace.cc writes these while it interposes malloc(3) & co.
+// A raw trace is one MallocHeader followed by MallocRecords in the
+// order the per-thread buffers were written, i.e. not sorted by time.
+// TraceConverter turns it into a trace as above.
+
+/// The first bytes of a raw trace file
+struct	MallocHeader {
+	char		magic[4];	///< always "MAMR"
+	uint32_t	version;	///< format version (1)
+};
+
+/// One malloc or free of a real program (32 bytes)
+struct	MallocRecord {
+	uint64_t	time;		///< CLOCK_MONOTONIC in nanoseconds
+	uint64_t	ptr;		///< the address: it identifies the object while it lives
+	uint64_t	size;		///< bytes asked for (0 for a free)
+	uint32_t	thread;		///< the thread, numbered from 1
+	uint32_t	op;			///< a TraceOp
+};
+
+#define	MALLOC_MAGIC	"MAMR"
+#define	MALLOC_VERSION	1
+
+#endif	/*Trace_h*/
+// vim:sw=4:ai:aw:ts=4:
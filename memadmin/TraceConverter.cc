@@ -0,0 +1,149 @@
+/** @file TraceConverter.cc
+ * De implementatie van TraceConverter.
+ */
+
+#include <algorithm>	// std::stable_sort
+#include <cerrno>		// errno
+#include <cstdio>		// fopen(3), fread(3), fwrite(3)
+#include <cstring>		// strerror(3), memcmp(3), memcpy(3)
+#include <map>			// the STL std::map<> container
+#include <stdexcept>	// std::runtime_error
+#include <string>		// std::string
+#include "main.h"
+#include "TraceConverter.h"
+
+
+namespace {
+
+/// Order the raw records by time
+struct	byTime {
+	bool	operator()(const MallocRecord& a, const MallocRecord& b) const
+	{ return a.time < b.time; }
+};
+
+/// What we know of a live object
+struct	Live {
+	uint32_t	id;
+	uint32_t	units;
+};
+
+}	// namespace
+
+
+// Read the whole raw trace
+TraceConverter::TraceConverter(const char *path)
+	: path(path), allocs(0), frees(0), skipped(0), leaked(0), threads(0), size(0)
+{
+	require(path != 0);
+	std::string  oops = std::string("Cannot read raw trace ") + path + ": ";
+	FILE  *fp = fopen(path, "rb");
+	if (!fp)
+		throw std::runtime_error(oops + strerror(errno));
+	MallocHeader  h;
+	if (fread(&h, sizeof(h), 1, fp) != 1
+	 || memcmp(h.magic, MALLOC_MAGIC, sizeof(h.magic)) != 0
+	 || h.version != MALLOC_VERSION) {
+		fclose(fp);
+		throw std::runtime_error(oops + "not a raw malloc trace");
+	}
+	MallocRecord  block[4096];
+	for (size_t n ; (n = fread(block, sizeof(MallocRecord), 4096, fp)) > 0 ; )
+		records.insert(records.end(), block, block + n);
+	fclose(fp);
+	std::stable_sort(records.begin(), records.end(), byTime());
+}
+
+
+// Write it as a memadmin trace
+void	TraceConverter::convert(const char *out, int unit)
+{
+	require(out != 0);
+	require(unit > 0);
+	std::string  oops = std::string("Cannot write trace ") + out + ": ";
+	FILE  *fp = fopen(out, "wb");
+	if (!fp)
+		throw std::runtime_error(oops + strerror(errno));
+
+	std::vector<TraceRecord>  trace;
+	trace.reserve(records.size());
+	std::map<uint64_t, Live>  live;		// by address
+	std::vector<uint32_t>  spare;		// ids that can be reused
+	uint32_t  nextid = 0;
+	long long  inuse = 0, peak = 0;		// units
+	uint64_t  t0 = records.empty() ? 0 : records.front().time;
+	for (size_t i = 0 ; i < records.size() ; ++i) {
+		const MallocRecord&  m = records[i];
+		if (m.thread > threads)
+			threads = m.thread;
+		TraceRecord  r;
+		r.time = m.time - t0;
+		r.id = 0;
+		if (m.op == TRACE_FREE) {
+			std::map<uint64_t, Live>::iterator  j = live.find(m.ptr);
+			if (j == live.end()) {
+				++skipped;				// not from malloc, or before we started
+				continue;
+			}
+			r.id = j->second.id;
+			r.sizeop = (j->second.units << 2) | TRACE_FREE;
+			inuse -= j->second.units;
+			spare.push_back(j->second.id);
+			live.erase(j);
+			++frees;
+		} else {
+			uint64_t  units = (m.size + unit - 1) / unit;
+			if (units == 0)
+				units = 1;				// malloc(0) is still an object
+			if (units > (1U << 29))
+				units = 1U << 29;		// what fits in TraceRecord::sizeop
+			r.sizeop = (uint32_t(units) << 2) | TRACE_FAIL;
+			if (m.op == TRACE_ALLOC) {
+				if (live.count(m.ptr)) {
+					++skipped;			// its free was not seen (e.g. from a memalign)
+					continue;
+				}
+				Live  l;
+				if (!spare.empty()) {
+					l.id = spare.back();
+					spare.pop_back();
+				} else {
+					l.id = nextid++;
+				}
+				l.units = uint32_t(units);
+				live[m.ptr] = l;
+				r.id = l.id;
+				r.sizeop = (l.units << 2) | TRACE_ALLOC;
+				inuse += units;
+				if (inuse > peak)
+					peak = inuse;
+			}
+			++allocs;
+		}
+		trace.push_back(r);
+	}
+	leaked = live.size();
+
+	// The memory must at least hold what was in use at the peak
+	size = uint32_t(2 * peak > 0 ? 2 * peak : 1);
+	TraceHeader  h;
+	memcpy(h.magic, TRACE_MAGIC, sizeof(h.magic));
+	h.version = TRACE_VERSION;
+	h.size = size;
+	h.maxid = (nextid > 0) ? (nextid - 1) : 0;
+	h.count = trace.size();
+	bool  ok = (fwrite(&h, sizeof(h), 1, fp) == 1)
+			&& (trace.empty() || fwrite(&trace[0], sizeof(TraceRecord), trace.size(), fp) == trace.size());
+	if (fclose(fp) != 0 || !ok)
+		throw std::runtime_error(oops + strerror(errno));
+}
+
+// Tell what was converted
+void	TraceConverter::report()
+{
+	std::cout << path << ": " << records.size() << " records from " << threads << " threads, "
+			  << allocs << " allocs, " << frees << " frees, "
+			  << skipped << " skipped, " << leaked << " never free'd\n";
+	std::cout << path << ": replay it with -s " << size << '\n';
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,54 @@
+#pragma once
+#ifndef	__TraceConverter_h__
+#define	__TraceConverter_h__	1.0
+
+/** @file TraceConverter.h
+ *  @brief Converts a raw malloc trace of a real program into a memadmin trace.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include "Trace.h"
+
+
+/// @class TraceConverter
+/// Leest een "raw" trace die preload/memtrace.cc van een echt programma
+/// gemaakt heeft en schrijft die als een gewone trace (zie Trace.h),
+/// zodat TraceReplay hem op elke allocator kan afspelen.
+/// De records worden op tijd gesorteerd (elke thread had een eigen
+/// buffer), bytes worden eenheden van 'unit' bytes (naar boven afgerond)
+/// en de adressen worden object-id's. Een free van een adres dat niet
+/// (via malloc) is uitgegeven wordt overgeslagen.
+/// Als omvang van het geheugen krijgt de trace tweemaal het grootste
+/// aantal eenheden dat tegelijk in gebruik was.
+class	TraceConverter
+{
+public:
+
+	/// Read the raw trace
+	/// @param path		the raw trace file
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	TraceConverter(const char *path);
+
+	/// Write the converted trace
+	/// @param path		the trace file to write
+	/// @param unit		the number of bytes per unit
+	void	convert(const char *path, int unit);
+
+	void	report();		///< tell what was converted
+
+private:
+
+	const char	*path;			///< the raw trace file
+	std::vector<MallocRecord>	records;	///< all of it
+
+	// Statistics of the conversion
+	long long	allocs;			///< allocs and failed allocs written
+	long long	frees;			///< frees written
+	long long	skipped;		///< unknown frees (and double allocs)
+	long long	leaked;			///< never free'd
+	uint32_t	threads;		///< threads seen
+	uint32_t	size;			///< memory size of the trace (units)
+};
+
+#endif	/*TraceConverter_h*/
+// vim:sw=4:ai:aw:ts=4:
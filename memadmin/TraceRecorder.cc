@@ -0,0 +1,120 @@
+/** @file TraceRecorder.cc
+ * De implementatie van TraceRecorder.
+ */
+
+#include <cerrno>		// errno
+#include <cstring>		// strerror(3), memcpy(3)
+#include <stdexcept>	// std::runtime_error
+#include <string>		// std::string
+#include "main.h"
+#include "TraceRecorder.h"
+#include "Histogram.h"	// for: nanotime()
+
+
+// Create the trace file
+TraceRecorder::TraceRecorder(Allocator *inner, const char *path)
+	: Wrapper(inner), path(path), fp(0), t0(nanotime())
+	, nextid(0), count(0)
+{
+	require(path != 0);
+	buffer.reserve(BUFSIZE);
+	fp = fopen(path, "wb");
+	if (!fp || !writeHeader())
+		throw std::runtime_error(std::string("Cannot write trace ") + path + ": " + strerror(errno));
+}
+
+// Write the remaining records and the final header
+TraceRecorder::~TraceRecorder()
+{
+	if (fp) {
+		flush();
+		writeHeader();
+		fclose(fp);
+	}
+}
+
+
+// Application wants 'wanted' memory
+Area	*TraceRecorder::alloc(int wanted)
+{
+	Area  *ap = inner->alloc(wanted);
+	if (!ap) {
+		put(TRACE_FAIL, wanted, 0);
+		return 0;
+	}
+	uint32_t  id;
+	if (!spare.empty()) {			// reuse an old id
+		id = spare.back();
+		spare.pop_back();
+	} else {
+		id = nextid++;
+	}
+	ids[ap] = id;
+	put(TRACE_ALLOC, wanted, id);
+	return ap;
+}
+
+// Application returns an area no longer needed
+void	TraceRecorder::free(Area *ap)
+{
+	std::map<const Area*, uint32_t>::iterator  i = ids.find(ap);
+	if (i != ids.end()) {			// NB an unknown area is passed on unrecorded
+		put(TRACE_FREE, ap->getSize(), i->second);
+		spare.push_back(i->second);
+		ids.erase(i);
+	}
+	inner->free(ap);
+}
+
+// Report statistics
+void	TraceRecorder::report()
+{
+	inner->report();
+	std::cout << type << ": " << (count + buffer.size()) << " records traced to " << path << '\n';
+}
+
+
+// ----- internal utilities -----
+
+// Add one record to the buffer
+void	TraceRecorder::put(TraceOp op, int size, uint32_t id)
+{
+	TraceRecord  r;
+	r.time = uint64_t(nanotime() - t0);
+	r.id = id;
+	r.sizeop = (uint32_t(size) << 2) | op;
+	buffer.push_back(r);
+	if (buffer.size() >= BUFSIZE && !flush())
+		throw std::runtime_error(std::string("Cannot write trace ") + path + ": " + strerror(errno));
+}
+
+// Write the buffered records
+bool	TraceRecorder::flush()
+{
+	if (buffer.empty())
+		return true;
+	size_t  n = fwrite(&buffer[0], sizeof(TraceRecord), buffer.size(), fp);
+	count += n;
+	bool  ok = (n == buffer.size());
+	buffer.clear();
+	return ok;
+}
+
+// (Re)write the header at the start of the file
+bool	TraceRecorder::writeHeader()
+{
+	TraceHeader  h;
+	memcpy(h.magic, TRACE_MAGIC, sizeof(h.magic));
+	h.version = TRACE_VERSION;
+	h.size = size;
+	h.maxid = (nextid > 0) ? (nextid - 1) : 0;
+	h.count = count;
+	long  here = ftell(fp);
+	bool  ok = (fseek(fp, 0, SEEK_SET) == 0)
+			&& (fwrite(&h, sizeof(h), 1, fp) == 1);
+	if (here > long(sizeof(h)))
+		fseek(fp, here, SEEK_SET);	// back to the end
+	return ok;
+}
+
+// vim:sw=4:ai:aw:ts=4:
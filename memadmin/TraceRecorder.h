@@ -0,0 +1,62 @@
+#pragma once
+#ifndef	__TraceRecorder_h__
+#define	__TraceRecorder_h__	1.0
+
+/** @file TraceRecorder.h
+ *  @brief An Allocator wrapper that records every alloc and free in a trace file.
+ */
+
+#include <cstdio>		// FILE
+#include <map>			// the STL std::map<> container
+#include <vector>		// the STL std::vector<> container
+#include "Wrapper.h"
+#include "Trace.h"
+
+
+/// @class TraceRecorder
+/// Een "doorgeef" allocator: alle aanvragen gaan naar de echte allocator
+/// ('inner'), maar elke alloc en free wordt ook in een binaire trace
+/// geschreven (zie Trace.h). Zo kan elk scenario vastgelegd worden
+/// en later met TraceReplay op iedere andere allocator afgespeeld worden.
+/// De records worden gebufferd en in blokken weggeschreven.
+class	TraceRecorder : public Wrapper
+{
+public:
+
+	/// @param inner	the allocator that does the real work (see Wrapper)
+	/// @param path		the name of the trace file
+	TraceRecorder(Allocator *inner, const char *path);
+
+	~TraceRecorder();		///< finish the trace file
+
+	/// Ask the inner allocator for an area of 'wanted' units.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// Return an area to the inner allocator.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	void	 report();		///< report statistics
+
+protected:
+
+	enum { BUFSIZE = 4096 };	///< records per write
+
+	const char	*path;		///< the trace file name
+	FILE		*fp;		///< the trace file
+	long long	 t0;		///< when we started (ns)
+
+	std::map<const Area*, uint32_t>	ids;	///< the id of each live area
+	std::vector<uint32_t>	spare;		///< ids that can be reused
+	uint32_t	 nextid;				///< the first id never used
+	uint64_t	 count;					///< records written so far
+	std::vector<TraceRecord>	buffer;	///< records not yet written
+
+	void	put(TraceOp op, int size, uint32_t id);	///< add one record
+	bool	flush();								///< write the buffer
+	bool	writeHeader();							///< (re)write the header
+};
+
+#endif	/*TraceRecorder_h*/
+// vim:sw=4:ai:aw:ts=4:
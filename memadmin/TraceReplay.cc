@@ -0,0 +1,134 @@
+/** @file TraceReplay.cc
+ * De implementatie van TraceReplay.
+ */
+
+#include <cerrno>		// errno
+#include <cstdio>		// fopen(3), fread(3)
+#include <cstring>		// strerror(3), memcmp(3)
+#include <stdexcept>	// std::runtime_error
+#include <string>		// std::string
+#ifdef	unix
+# include <fcntl.h>		// open(2)
+# include <unistd.h>	// close(2)
+# include <sys/mman.h>	// mmap(2), munmap(2)
+# include <sys/stat.h>	// fstat(2)
+#endif
+#include "main.h"
+#include "TraceReplay.h"
+#include "Stopwatch.h"
+
+
+// Map the trace file and check the header
+TraceReplay::TraceReplay(const char *path)
+	: path(path), header(0), records(0), base(0), length(0)
+{
+	require(path != 0);
+	std::string  oops = std::string("Cannot read trace ") + path + ": ";
+#ifdef	unix
+	int  fd = open(path, O_RDONLY);
+	struct stat  st;
+	if (fd < 0 || fstat(fd, &st) < 0)
+		throw std::runtime_error(oops + strerror(errno));
+	length = st.st_size;
+	if (length >= sizeof(TraceHeader)) {
+		base = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (base == MAP_FAILED) {
+			base = 0;
+			close(fd);
+			throw std::runtime_error(oops + strerror(errno));
+		}
+		madvise(base, length, MADV_SEQUENTIAL);		// we read it only once, from front to back
+	}
+	close(fd);
+	header = static_cast<const TraceHeader*>(base);
+#else
+	FILE  *fp = fopen(path, "rb");
+	if (!fp)
+		throw std::runtime_error(oops + strerror(errno));
+	char  block[65536];
+	for (size_t n ; (n = fread(block, 1, sizeof(block), fp)) > 0 ; )
+		data.insert(data.end(), block, block + n);
+	fclose(fp);
+	length = data.size();
+	if (length >= sizeof(TraceHeader))
+		header = reinterpret_cast<const TraceHeader*>(&data[0]);
+#endif
+
+	if (!header
+	 || memcmp(header->magic, TRACE_MAGIC, sizeof(header->magic)) != 0
+	 || header->version != TRACE_VERSION)
+		throw std::runtime_error(oops + "not a trace file");
+	if (length < sizeof(TraceHeader) + header->count * sizeof(TraceRecord))
+		throw std::runtime_error(oops + "file is truncated");
+	records = reinterpret_cast<const TraceRecord*>(header + 1);
+}
+
+// Unmap the trace file
+TraceReplay::~TraceReplay()
+{
+#ifdef	unix
+	if (base)
+		munmap(base, length);
+#endif
+}
+
+
+// Replay all records
+void	TraceReplay::run(Allocator *beheerder)
+{
+	require(beheerder != 0);
+	std::vector<Area*>  live(header->maxid + 1, (Area*)0);	// the live areas by id
+	long long  fails = 0;		// allocs that failed, but did not in the recording
+	long long  extra = 0;		// allocs that succeeded, but failed in the recording
+	long long  skipped = 0;		// frees of areas we never got
+	const uint64_t  n = header->count;
+
+	Stopwatch  klok;
+	klok.start();
+	for (uint64_t i = 0 ; i < n ; ++i) {
+		const TraceRecord&  r = records[i];
+		switch (r.getOp()) {
+		case TRACE_ALLOC:
+			require(r.id <= header->maxid);
+			if ((live[r.id] = beheerder->alloc(r.getSize())) == 0)
+				++fails;
+			break;
+		case TRACE_FREE:
+			require(r.id <= header->maxid);
+			if (live[r.id]) {
+				beheerder->free(live[r.id]);
+				live[r.id] = 0;
+			} else {
+				++skipped;
+			}
+			break;
+		case TRACE_FAIL:
+			// The application did not get anything then,
+			// so whatever we get now is given back at once
+			if (Area  *ap = beheerder->alloc(r.getSize())) {
+				++extra;
+				beheerder->free(ap);
+			}
+			break;
+		default:
+			notreached();
+		}
+	}
+	klok.stop();
+
+	// Give back what the trace left allocated
+	for (size_t id = 0 ; id < live.size() ; ++id) {
+		if (live[id])
+			beheerder->free(live[id]);
+	}
+
+	klok.report();
+	std::cout << n << " records replayed from " << path << ", "
+			  << (n ? klok.gettotal() * 1e9 / n : 0.0) << " ns per record\n";
+	std::cout << fails << " allocs failed (that did not when recorded), "
+			  << extra << " succeeded (that failed when recorded), "
+			  << skipped << " frees skipped\n";
+	beheerder->report();
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,53 @@
+#pragma once
+#ifndef	__TraceReplay_h__
+#define	__TraceReplay_h__	1.0
+
+/** @file TraceReplay.h
+ *  @brief Replays a binary alloc/free trace on an Allocator.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include "Allocator.h"
+#include "Trace.h"
+
+
+/// @class TraceReplay
+/// Speelt een trace (zie Trace.h en TraceRecorder) af op een allocator.
+/// De file wordt in zijn geheel in het geheugen "gemapt" (mmap(2)) zodat
+/// de lus over de records alleen maar alloc en free aanroept: geen
+/// iostreams, geen random getallen en geen zoeken naar objecten
+/// (de levende gebieden staan in een array op hun id).
+class	TraceReplay
+{
+public:
+
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	/// Open and check the trace file
+	/// @param path		the name of the trace file
+	TraceReplay(const char *path);
+
+	~TraceReplay();			///< unmap the trace file
+
+	/// The memory size the trace was recorded with.
+	int			getSize() const		{ return int(header->size); }
+
+	/// The number of records in the trace.
+	uint64_t	getCount() const	{ return header->count; }
+
+	/// Feed all records to the allocator, as fast as possible,
+	/// and then report the time used and the allocator statistics.
+	/// @param beheerder	the allocator (with its size already set)
+	void	run(Allocator *beheerder);
+
+private:
+
+	const char			*path;		///< the trace file name
+	const TraceHeader	*header;	///< the start of the file
+	const TraceRecord	*records;	///< the records that follow it
+	void				*base;		///< what mmap gave us
+	size_t				 length;	///< the size of the mapping
+	std::vector<char>	 data;		///< or a copy, where mmap is not available
+};
+
+#endif	/*TraceReplay_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,150 @@
+/** @file TreeBestFit.cc
+ * De implementatie van TreeBestFit.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include <algorithm>	// for: std::sort()
+
+#include "TreeBestFit.h"
+#include "ansi.h"
+
+
+// Clean up dead stuff
+TreeBestFit::~TreeBestFit()
+{
+	for (AreaTree::iterator  i = areas.begin() ; i != areas.end() ; ++i) {
+		delete *i;
+	}
+	areas.clear();
+}
+
+// Initializes how much memory we own
+void  TreeBestFit::setSize(int new_size)
+{
+	require(areas.empty());					// prevent changing the size when the freelist is nonempty
+	Fitter::setSize(new_size);
+	areas.insert(new Area(0, new_size));	// and create the first free area (i.e. "all")
+}
+
+// Print the current free tree (in size order) for debugging
+void	TreeBestFit::dump()
+{
+	std::cerr << AC_BLUE << type << "::areas";
+	for (AreaTree::iterator  i = areas.begin() ; i != areas.end() ; ++i) {
+		std::cerr << ' ' << **i;
+	}
+	std::cerr << AA_RESET << std::endl;
+}
+
+
+// Application wants 'wanted' memory
+Area  *TreeBestFit::alloc(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	updateStats();				// update resource map statistics
+
+	if (areas.empty()) {		// iff we have nothing
+		return 0;				// give up immediately
+	}
+
+	Area  *ap = searcher(wanted);	// first attempt
+	if (ap) {						// success ?
+		return given(ap);
+	}
+	if (reclaim()) {				// could we reclaim fragmented freespace ?
+		ap = searcher(wanted);		// then make a second attempt
+		if (ap) {					// success ?
+			return given(ap);
+		}
+	}
+	// Alas, failed to allocate anything
+	//dump();//DEBUG
+	return 0;						// inform caller we failed
+}
+
+
+// Application returns an area no longer needed
+void	TreeBestFit::free(Area *ap)
+{
+	require(ap != 0);
+	taken(ap);				// the sanity check (in check mode only)
+	areas.insert(ap);		// the lazy version: O(log n)
+}
+
+// All areas in the tree
+bool	TreeBestFit::freeSpace(FreeSpace& fs)
+{
+	for (AreaTree::iterator  i = areas.begin() ; i != areas.end() ; ++i)
+		fs.add((*i)->getSize());
+	return true;
+}
+
+
+// ----- internal utilities -----
+
+// Search for the smallest area with at least 'wanted' memory
+Area  *TreeBestFit::searcher(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	// Since base 0 is the lowest possible address, the first element
+	// not less than this probe is the smallest area of at least 'wanted'
+	// units (and, amongst equals, the one with the lowest address).
+	Area  probe(0, wanted);
+	AreaTree::iterator  i = areas.lower_bound(&probe);
+	if (i == areas.end()) {
+		return 0;						// report failure
+	}
+
+	Area  *ap = *i;
+	areas.erase(i);						// Remove this element from the tree
+	if (ap->getSize() > wanted) {		// Larger than needed ?
+		Area  *rp = ap->split(wanted);	// Split into two parts (updating sizes)
+		areas.insert(rp);				// and put the remainder back: O(log n)
+	}
+	return  ap;
+}
+
+
+// We have run out of usefull areas;
+// Try to reclaim space by joining fragmented freespace
+bool	TreeBestFit::reclaim()
+{
+	// Collect all free areas and sort them by address
+	std::vector<Area*>  all(areas.begin(), areas.end());
+	areas.clear();
+	std::sort(all.begin(), all.end(), Area::orderByAddress());	// WARNING: expensive N*log(N) operation !
+
+	// Merge successive areas and put the results back in the tree
+	bool  changed = false;
+	Area  *ap = 0;					// The current candidate ...
+	for (std::vector<Area*>::iterator  i = all.begin() ; i != all.end() ; ++i) {
+		Area  *bp = *i;				// ... match it with.
+		if (ap && (bp->getBase() == (ap->getBase() + ap->getSize()))) {
+			ap->join(bp);			// append area bp to ap (and destroy bp)
+			++mergers;				// update statistics
+			changed = true;			// we changed something
+		} else {
+			if (ap)
+				areas.insert(ap);	// ap is as large as it gets
+			ap = bp;				// move on to next free area
+		}
+	}
+	if (ap)
+		areas.insert(ap);
+	++reclaims;	// update statistics ("reclaims attempted")
+	return changed;
+}
+
+// Update statistics
+void	TreeBestFit::updateStats()
+{
+	++qcnt;									// number of 'alloc's
+	qsum  += areas.size();					// length of resource map
+	qsum2 += (areas.size() * areas.size());	// same: squared
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef	__TreeBestFit_h__
+#define	__TreeBestFit_h__	1.0
+
+/** @file TreeBestFit.h
+ *  @brief The class that implements a BestFit algorithm on a size-ordered tree.
+ */
+
+#include <set>			// the STL std::set<> container
+#include "Fitter.h"
+
+
+/// @class TreeBestFit
+/// Het BestFit algorithme gebruikt het kleinste gebied dat nog groot genoeg is.
+/// Deze versie bewaart de vrije gebieden in een gebalanceerde boom (std::set)
+/// gesorteerd op omvang en bij gelijke omvang op adres, zodat de "best fit"
+/// met een enkele lower_bound gevonden wordt i.p.v. de hele lijst af te lopen.
+/// This is the lazy version.
+class	TreeBestFit : public Fitter
+{
+public:
+
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	/// @param cflag	initial status of check-mode
+	/// @param type		name of this algorithm (default=TreeBestFit)
+	TreeBestFit(bool cflag, const char *type = "BestFit (tree)")
+		: Fitter(cflag, type) {}
+
+	/// Cleanup free areas
+	~TreeBestFit();
+
+	void	 setSize(int new_size);	///< initialize memory size
+
+	/// Ask for an area of at least 'wanted' units.
+	/// @returns	An area or 0 if not enough freespace available
+	Area	*alloc(int wanted);
+
+	/// The application returns an area to freespace.
+	/// @param ap	The area returned to free space
+	void	 free(Area *ap);
+
+	bool	 freeSpace(FreeSpace& fs);	///< the free areas (see Allocator::freeSpace)
+
+protected:
+
+	/// The free areas ordered by size, then by address
+	typedef	std::set<Area*, Area::orderBySizeThenAddress, PoolAllocator<Area*> >	AreaTree;
+
+	AreaTree	areas;		///< all the available free areas
+
+	/// For debugging this function shows the free area tree
+	void	dump();
+
+	/// This is the actual function that searches for space.
+	/// @returns	An area or 0 if not enough freespace available
+	Area 	*searcher(int);
+
+	/// This function is called when the searcher can not find space.
+	/// It tries to reclaim fragmented space by merging adjacent free areas.
+	/// @returns true if free areas could be merged, false if no adjacent areas exist
+	bool	 reclaim();
+
+	void	 updateStats();	///< update resource map statistics
+};
+
+#endif	/*TreeBestFit_h*/
+// vim:sw=4:ai:aw:ts=4:
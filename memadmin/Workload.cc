@@ -0,0 +1,274 @@
+/** @file Workload.cc
+ * De implementatie van Workload.
+ */
+
+#include <algorithm>	// std::push_heap, std::upper_bound
+#include <cctype>		// isspace(3)
+#include <cmath>		// log(3), exp(3), sqrt(3), pow(3)
+#include <cstdlib>		// strtod(3)
+#include <fstream>		// std::ifstream
+#include <functional>	// std::greater
+#include <stdexcept>	// std::runtime_error
+#include "main.h"
+#include "Workload.h"
+
+
+namespace {
+
+/// Split 'text' at every 'sep'
+std::vector<std::string>	split(const std::string& text, char sep)
+{
+	std::vector<std::string>  out;
+	std::string::size_type  b = 0, e;
+	while ((e = text.find(sep, b)) != std::string::npos) {
+		out.push_back(text.substr(b, e - b));
+		b = e + 1;
+	}
+	out.push_back(text.substr(b));
+	return out;
+}
+
+/// A number, or else a clear complaint
+double	number(const std::string& text)
+{
+	char  *end;
+	double  d = strtod(text.c_str(), &end);
+	if (text.empty() || *end)
+		throw std::runtime_error("Workload: '" + text + "' is not a number");
+	return d;
+}
+
+/// The smallest to die first
+typedef	std::pair<long long, Area*>	Death;
+typedef	std::greater<Death>			Sooner;
+
+}	// namespace
+
+
+// Read the description
+Workload::Workload(const std::string& text)
+	: spec(text), seed(1), sizes(UNIFORM), lives(EXP), mean(100)
+	, now(0), doomed(0)
+{
+	p[0] = 1;
+	p[1] = 100;
+	p[2] = 0;
+	std::string  all = text;
+	if (!text.empty() && text[0] == '@') {		// from a file
+		std::ifstream  in(text.c_str() + 1);
+		if (!in)
+			throw std::runtime_error("Workload: cannot read " + text.substr(1));
+		all.clear();
+		for (std::string line ; std::getline(in, line) ; ) {
+			std::string::size_type  hash = line.find('#');		// comments
+			if (hash != std::string::npos)
+				line.erase(hash);
+			all += line + ',';
+		}
+	}
+	std::vector<std::string>  pairs = split(all, ',');
+	for (size_t i = 0 ; i < pairs.size() ; ++i) {
+		std::string  kv;
+		for (size_t k = 0 ; k < pairs[i].size() ; ++k)		// no white space
+			if (!isspace((unsigned char)pairs[i][k]))
+				kv += pairs[i][k];
+		if (kv.empty())
+			continue;
+		std::string::size_type  eq = kv.find('=');
+		if (eq == std::string::npos)
+			throw std::runtime_error("Workload: expected name=value, not '" + kv + "'");
+		parse(kv.substr(0, eq), kv.substr(eq + 1));
+	}
+	restart();
+}
+
+// Start again from the beginning
+void	Workload::restart()
+{
+	rng.reseed(seed);
+	now = 0;
+	deaths.clear();
+	alive.clear();
+	doomed = 0;
+}
+
+
+// The size of the next object
+int		Workload::nextSize()
+{
+	double  s = 1;
+	switch (sizes) {
+	case UNIFORM:
+		s = rng.between(int(p[0]), int(p[1]));
+		break;
+	case ZIPF:		// NB cdf[k] is the chance of LO+k or less
+		s = p[0] + (std::upper_bound(cdf.begin(), cdf.end(), rng.uniform()) - cdf.begin());
+		break;
+	case LOGNORMAL:	// Box-Muller
+		{
+			double  u = 1.0 - rng.uniform();		// (0,1]
+			double  v = rng.uniform();
+			double  z = sqrt(-2.0 * log(u)) * cos(2 * 3.14159265358979323846 * v);
+			s = exp(p[0] + p[1] * z) + 0.5;
+		}
+		break;
+	case BIMODAL:
+		s = (rng.uniform() < p[2]) ? p[0] : p[1];
+		break;
+	case EMPIRICAL:
+		{
+			size_t  k = std::upper_bound(cdf.begin(), cdf.end(), rng.uniform()) - cdf.begin();
+			s = values[std::min(k, values.size() - 1)];
+		}
+		break;
+	}
+	if (s < 1)
+		s = 1;
+	if (s > 2e9)
+		s = 2e9;
+	return int(s);
+}
+
+// Who dies now ?
+Area	*Workload::victim()
+{
+	Area  *ap = 0;
+	switch (lives) {
+	case EXP:
+		if (!deaths.empty() && deaths.front().first <= now) {
+			ap = deaths.front().second;
+			std::pop_heap(deaths.begin(), deaths.end(), Sooner());
+			deaths.pop_back();
+		}
+		break;
+	case PHASE:
+		if (now > 0 && now % (long long)mean == 0)
+			doomed = alive.size();		// the end of a phase: all of it goes
+		if (doomed > 0) {
+			ap = alive.front();
+			alive.pop_front();
+			--doomed;
+		}
+		break;
+	case FIFO:
+		if (alive.size() >= size_t(mean)) {
+			ap = alive.front();
+			alive.pop_front();
+		}
+		break;
+	case LIFO:
+		if (alive.size() >= size_t(mean)) {
+			ap = alive.back();
+			alive.pop_back();
+		}
+		break;
+	}
+	return ap;
+}
+
+// A new object: decide when it dies
+void	Workload::born(Area *ap)
+{
+	require(ap != 0);
+	if (lives == EXP) {
+		long long  life = (long long)(-mean * log(1.0 - rng.uniform())) + 1;
+		deaths.push_back(Death(now + life, ap));
+		std::push_heap(deaths.begin(), deaths.end(), Sooner());
+	} else {
+		alive.push_back(ap);
+	}
+}
+
+// Print what this workload is
+void	Workload::report() const
+{
+	static const char  *sname[] = { "uniform", "zipf", "lognormal", "bimodal", "empirical" };
+	static const char  *lname[] = { "exp", "phase", "fifo", "lifo" };
+	std::cout << "Workload: sizes " << sname[sizes] << ", lifetimes " << lname[lives] << ' ' << mean
+			  << ", seed " << seed << '\n';
+}
+
+
+// ----- internal utilities -----
+
+// One name=value pair
+void	Workload::parse(const std::string& key, const std::string& value)
+{
+	std::vector<std::string>  f = split(value, ':');
+	if (key == "size")
+		parseSizes(f);
+	else if (key == "life")
+		parseLives(f);
+	else if (key == "seed")
+		seed = uint64_t(number(value));
+	else
+		throw std::runtime_error("Workload: unknown setting '" + key + "'");
+}
+
+// size=...
+void	Workload::parseSizes(const std::vector<std::string>& f)
+{
+	const std::string&  name = f[0];
+	size_t  want = 0;
+	if (name == "uniform")			{ sizes = UNIFORM;	 want = 2; }
+	else if (name == "zipf")		{ sizes = ZIPF;		 want = 3; }
+	else if (name == "lognormal")	{ sizes = LOGNORMAL; want = 2; }
+	else if (name == "bimodal")		{ sizes = BIMODAL;	 want = 3; }
+	else if (name == "empirical")	{ sizes = EMPIRICAL; want = f.size() - 1; }
+	else
+		throw std::runtime_error("Workload: unknown size distribution '" + name + "'");
+	if (f.size() != want + 1 || want == 0)
+		throw std::runtime_error("Workload: wrong number of parameters for size=" + name);
+
+	cdf.clear();
+	values.clear();
+	if (sizes == EMPIRICAL) {
+		double  total = 0;
+		for (size_t i = 1 ; i < f.size() ; ++i) {
+			std::vector<std::string>  sw = split(f[i], '=');
+			if (sw.size() != 2)
+				throw std::runtime_error("Workload: expected size=weight, not '" + f[i] + "'");
+			values.push_back(int(number(sw[0])));
+			total += number(sw[1]);
+			cdf.push_back(total);
+		}
+		for (size_t i = 0 ; i < cdf.size() ; ++i)
+			cdf[i] /= total;
+		return;
+	}
+	for (size_t i = 0 ; i < want ; ++i)
+		p[i] = number(f[i + 1]);
+	if ((sizes == UNIFORM || sizes == ZIPF) && !(1 <= p[0] && p[0] <= p[1]))
+		throw std::runtime_error("Workload: need 1 <= LO <= HI");
+	if (sizes == ZIPF) {
+		long long  n = (long long)(p[1] - p[0]) + 1;
+		if (n > (1 << 20))
+			throw std::runtime_error("Workload: zipf range too large");
+		double  total = 0;
+		for (long long k = 1 ; k <= n ; ++k) {
+			total += 1.0 / pow(double(k), p[2]);
+			cdf.push_back(total);
+		}
+		for (size_t i = 0 ; i < cdf.size() ; ++i)
+			cdf[i] /= total;
+	}
+}
+
+// life=...
+void	Workload::parseLives(const std::vector<std::string>& f)
+{
+	const std::string&  name = f[0];
+	if (name == "exp")			lives = EXP;
+	else if (name == "phase")	lives = PHASE;
+	else if (name == "fifo")	lives = FIFO;
+	else if (name == "lifo")	lives = LIFO;
+	else
+		throw std::runtime_error("Workload: unknown lifetime distribution '" + name + "'");
+	if (f.size() != 2)
+		throw std::runtime_error("Workload: life=" + name + " needs one parameter");
+	mean = number(f[1]);
+	if (mean < 1)
+		throw std::runtime_error("Workload: life=" + name + " needs a parameter >= 1");
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,121 @@
+#pragma once
+#ifndef	__Workload_h__
+#define	__Workload_h__	1.0
+
+/** @file Workload.h
+ *  @brief A configurable workload: how big the objects are and how long they live.
+ */
+
+#include <deque>		// the STL std::deque<> container
+#include <string>		// std::string
+#include <utility>		// std::pair
+#include <vector>		// the STL std::vector<> container
+#include <stdint.h>		// uint64_t
+#include "Area.h"
+
+
+/// @class Random
+/// Een snelle random generator (xorshift64*) met een eigen toestand.
+/// Anders dan rand(3) is hij herhaalbaar per seed, ook als iemand
+/// anders ook random getallen trekt, en hij kost maar een paar instructies.
+class	Random
+{
+public:
+	/// @param seed	the start value (0 is replaced)
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	Random(uint64_t seed = 1) { reseed(seed); }
+
+	void	reseed(uint64_t seed)	{ state = seed ? seed : 0x9E3779B97F4A7C15ULL; }
+
+	/// The next 64 random bits
+	uint64_t	next()
+	{
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 2685821657736338717ULL;
+	}
+
+	/// A number in [0,1)
+	double	uniform()	{ return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+	/// A number in [lo,hi]
+	int		between(int lo, int hi)	{ return lo + int(next() % uint64_t(hi - lo + 1)); }
+
+private:
+	uint64_t	state;
+};
+
+
+/// @class Workload
+/// Beschrijft een werklast: de verdeling van de omvang van de objecten
+/// en die van hun levensduur. De beschrijving is een lijst van
+/// "naam=waarde" paren, gescheiden door komma's of regels (in een file):
+/// @code
+///	size=uniform:LO:HI				gelijk verdeeld tussen LO en HI
+///	size=zipf:LO:HI:S				LO het vaakst, kans op LO+k-1 is evenredig met 1/k^S
+///	size=lognormal:MU:SIGMA			ln(omvang) is normaal verdeeld
+///	size=bimodal:A:B:P				A met kans P, anders B
+///	size=empirical:S=W:S=W:...		omvang S met gewicht W
+///	life=exp:MEAN					exponentieel, gemiddeld MEAN acties
+///	life=phase:LEN					alles uit een fase van LEN acties sterft samen
+///	life=fifo:N						N levende objecten, de oudste sterft eerst
+///	life=lifo:N						N levende objecten, de jongste sterft eerst
+///	seed=N							de seed van de random generator
+/// @endcode
+/// De tijd telt in acties (allocs en frees). 'victim' vertelt welk object
+/// nu moet sterven, anders wil de werklast een nieuw object van 'nextSize'.
+class	Workload
+{
+public:
+
+	/// @param spec		the description, or "@file" to read it from a file
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	Workload(const std::string& spec);
+
+	/// Start again: the same seed gives the same workload
+	void	restart();
+
+	int		nextSize();			///< the size of the next object (>= 1)
+
+	/// The object that must die now, if any
+	/// @returns	the area to free, or 0 if it is time for an alloc
+	Area	*victim();
+
+	/// A new object was made
+	/// @param ap	its area
+	void	born(Area *ap);
+
+	void	tick()	{ ++now; }	///< one action was done
+
+	void	report() const;		///< print what this workload is
+
+private:
+
+	enum Sizes { UNIFORM, ZIPF, LOGNORMAL, BIMODAL, EMPIRICAL };
+	enum Lives { EXP, PHASE, FIFO, LIFO };
+
+	std::string		spec;		///< as given
+	Random			rng;
+	uint64_t		seed;
+
+	Sizes			sizes;		///< the size distribution
+	double			p[3];		///< its parameters
+	std::vector<double>	cdf;	///< zipf & empirical: cumulative probabilities
+	std::vector<int>	values;	///< empirical: the sizes
+
+	Lives			lives;		///< the lifetime distribution
+	double			mean;		///< exp: mean lifetime; phase: length; fifo/lifo: live objects
+
+	long long		now;		///< actions done
+	std::vector< std::pair<long long, Area*> >	deaths;	///< exp: a min-heap of (death, area)
+	std::deque<Area*>	alive;	///< phase, fifo, lifo: in order of birth
+	size_t			doomed;		///< phase: alive[0..doomed) die now
+
+	void	parse(const std::string& key, const std::string& value);
+	void	parseSizes(const std::vector<std::string>& f);
+	void	parseLives(const std::vector<std::string>& f);
+};
+
+#endif	/*Workload_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,198 @@
+/** @file WorstFit.cc
+ * De implementatie van WorstFit.
+ */
+
+#include <algorithm>	// for: std::push_heap() etc
+#include "WorstFit.h"
+#include "ansi.h"
+
+
+// Clean up dead stuff
+WorstFit::~WorstFit()
+{
+	for (size_t b = 0 ; b < heads.size() ; ++b) {
+		delete heads[b];
+	}
+}
+
+// Initializes how much memory we own
+void  WorstFit::setSize(int new_size)
+{
+	require(count == 0);				// prevent changing the size when the heap is nonempty
+	Fitter::setSize(new_size);
+	heads.assign(new_size, (Area*)0);
+	tails.assign(new_size, (Area*)0);
+	enter(new Area(0, new_size));		// and create the first free area (i.e. "all")
+}
+
+// Print the current free areas for debugging
+void	WorstFit::dump()
+{
+	std::cerr << AC_BLUE << type << "::heap";
+	for (size_t i = 0 ; i < heap.size() ; ++i) {
+		if (valid(heap[i]))
+			std::cerr << ' ' << *heads[heap[i].base];
+	}
+	std::cerr << AA_RESET << std::endl;
+}
+
+
+// Application wants 'wanted' memory
+Area  *WorstFit::alloc(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	updateStats();				// update resource map statistics
+
+	if (count == 0) {			// iff we have nothing
+		return 0;				// give up immediately
+	}
+
+	Area  *ap = searcher(wanted);	// first attempt
+	if (ap) {					// success ?
+		return given(ap);
+	}
+	if (reclaim()) {			// could we reclaim fragmented freespace ?
+		ap = searcher(wanted);	// then make a second attempt
+		if (ap) {				// success ?
+			return given(ap);
+		}
+	}
+	// Alas, failed to allocate anything
+	//dump();//DEBUG
+	return 0;					// inform caller we failed
+}
+
+
+// Application returns an area no longer needed
+void	WorstFit::free(Area *ap)
+{
+	require(ap != 0);
+	taken(ap);				// the sanity check (in check mode only)
+	enter(ap);				// the lazy version: no merging here
+}
+
+// The heap has stale entries, so walk the boundary tags instead
+bool	WorstFit::freeSpace(FreeSpace& fs)
+{
+	for (int b = 0 ; b < size ; ) {
+		if (heads[b]) {
+			fs.add(heads[b]->getSize());
+			b += heads[b]->getSize();		// free areas do not overlap
+		} else
+			++b;
+	}
+	return true;
+}
+
+
+// ----- internal utilities -----
+
+// Register a free area: tag both ends and push it on the heap
+void	WorstFit::enter(Area *ap)
+{
+	heads[ap->getBase()] = ap;
+	tails[ap->getLast()] = ap;
+	++count;
+	heap.push_back(Entry(ap->getSize(), ap->getBase()));
+	std::push_heap(heap.begin(), heap.end());
+	if (heap.size() > 2 * size_t(count) + 64)	// too many stale entries ?
+		rebuild();
+}
+
+// Unregister a free area: its heap entry becomes stale
+void	WorstFit::leave(Area *ap)
+{
+	heads[ap->getBase()] = 0;
+	tails[ap->getLast()] = 0;
+	--count;
+}
+
+// Rebuild the heap with only the valid entries
+void	WorstFit::rebuild()
+{
+	std::vector<Entry>  fresh;
+	fresh.reserve(2 * count);
+	for (size_t i = 0 ; i < heap.size() ; ++i) {
+		if (valid(heap[i]))
+			fresh.push_back(heap[i]);
+	}
+	std::sort(fresh.begin(), fresh.end());							// an area may have been
+	fresh.erase(std::unique(fresh.begin(), fresh.end()), fresh.end());	// pushed twice
+	heap.swap(fresh);
+	std::make_heap(heap.begin(), heap.end());
+}
+
+// Search for the largest area
+Area  *WorstFit::searcher(int wanted)
+{
+	require(wanted > 0);		// has to be "something",
+	require(wanted <= size);	// but not more than can exist
+
+	// Skip the stale entries on top of the heap
+	while (!heap.empty() && !valid(heap.front())) {
+		std::pop_heap(heap.begin(), heap.end());
+		heap.pop_back();
+	}
+	if (heap.empty() || (heap.front().size < wanted)) {
+		return 0;				// even the largest is too small
+	}
+
+	Area  *ap = heads[heap.front().base];
+	std::pop_heap(heap.begin(), heap.end());
+	heap.pop_back();
+	leave(ap);
+	if (ap->getSize() > wanted) {		// Larger than needed ?
+		Area  *rp = ap->split(wanted);	// Split into two parts (updating sizes)
+		enter(rp);						// the remainder stays free
+	}
+	return ap;
+}
+
+
+// We have run out of usefull areas;
+// Try to reclaim space by joining fragmented freespace
+bool	WorstFit::reclaim()
+{
+	// Collect all free areas, sorted by address
+	std::vector<Area*>  all;
+	all.reserve(count);
+	for (size_t i = 0 ; i < heap.size() ; ++i) {
+		if (valid(heap[i]))
+			all.push_back(heads[heap[i].base]);
+	}
+	std::sort(all.begin(), all.end(), Area::orderByAddress());	// WARNING: expensive N*log(N) operation !
+	all.erase(std::unique(all.begin(), all.end()), all.end());	// an area may have been pushed twice
+
+	// Merge successive areas that touch
+	bool  changed = false;
+	heap.clear();
+	size_t  n = 0;				// the merged areas are compacted in all[0..n)
+	for (size_t i = 0 ; i < all.size() ; ++i) {
+		Area  *bp = all[i];
+		leave(bp);
+		if (n > 0 && (bp->getBase() == all[n - 1]->getBase() + all[n - 1]->getSize())) {
+			all[n - 1]->join(bp);	// append area bp to the previous one (and destroy bp)
+			++mergers;				// update statistics
+			changed = true;			// we changed something
+		} else {
+			all[n++] = bp;
+		}
+	}
+	for (size_t i = 0 ; i < n ; ++i) {
+		enter(all[i]);
+	}
+	++reclaims;	// update statistics ("reclaims attempted")
+	return changed;
+}
+
+// Update statistics
+void	WorstFit::updateStats()
+{
+	++qcnt;									// number of 'alloc's
+	qsum  += count;							// number of free areas
+	qsum2 += ((long long)count * count);	// same: squared
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,95 @@
+#pragma once
+#ifndef	__WorstFit_h__
+#define	__WorstFit_h__	1.0
+
+/** @file WorstFit.h
+ *  @brief The class that implements the lazy version of the WorstFit algorithm.
+ */
+
+#include <vector>		// the STL std::vector<> container
+#include "Fitter.h"
+
+
+/// @class WorstFit
+/// Het WorstFit algorithme gebruikt altijd het grootste vrije gebied,
+/// in de hoop dat de rest nog bruikbaar groot blijft.
+/// Dit is de lazy versie.
+/// De vrije gebieden staan in een max-heap op omvang, het grootste
+/// gebied is dus in O(1) te vinden en in O(log n) te verwijderen.
+/// Een heap kan niet zomaar een willekeurig element kwijtraken, daarom
+/// worden entries "lui" verwijderd: een entry is alleen nog geldig als
+/// er op dat adres nog een vrij gebied van die omvang begint
+/// (zie 'heads'); ongeldige entries worden overgeslagen zodra ze
+/// bovenaan komen.
+class	WorstFit : public Fitter
+{
+public:
+
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	/// @param cflag	initial status of check-mode
+	/// @param type		name of this algorithm (default=WorstFit)
+	WorstFit(bool cflag, const char *type = "WorstFit (lazy)")
+		: Fitter(cflag, type), count(0) {}
+
+	/// Cleanup free areas
+	~WorstFit();
+
+	void	 setSize(int new_size);	///< initialize memory size
+
+	/// Ask for an area of at least 'wanted' units.
+	/// @returns	An area or 0 if not enough freespace available
+	virtual  Area	*alloc(int wanted);	// application asks for space
+
+	/// The application returns an area to freespace.
+	/// @param ap	The area returned to free space
+	virtual  void	free(Area *ap);
+
+	bool	 freeSpace(FreeSpace& fs);	///< the free areas (see Allocator::freeSpace)
+
+protected:
+
+	/// A heap entry: the size and address of a (possibly no longer) free area
+	struct	Entry {
+		int		size;
+		int		base;
+		Entry(int size, int base) : size(size), base(base) {}
+		/// Heap order: larger sizes first, on a tie the lower address
+		bool	operator<(const Entry& that) const {
+			return (size < that.size) || ((size == that.size) && (base > that.base));
+		}
+		bool	operator==(const Entry& that) const {
+			return (size == that.size) && (base == that.base);
+		}
+	};
+
+	std::vector<Entry>	heap;	///< max-heap of all free areas (plus stale entries)
+	std::vector<Area*>	heads;	///< heads[b] = the free area starting at b, or 0
+	std::vector<Area*>	tails;	///< tails[l] = the free area ending at l, or 0
+	int					count;	///< the number of free areas
+
+	/// Is this heap entry still a free area?
+	bool	valid(const Entry& e) const
+	{ return heads[e.base] && (heads[e.base]->getSize() == e.size); }
+
+	void	enter(Area *ap);	///< register a free area (tags and heap)
+	void	leave(Area *ap);	///< unregister a free area (only the tags)
+
+	void	rebuild();			///< throw away the stale heap entries
+
+	/// For debugging this function shows the free areas
+	virtual	 void	dump();
+
+	/// This is the actual function that searches for space.
+	/// @returns	An area or 0 if not enough freespace available
+	Area 	*searcher(int);
+
+	/// This function is called when the searcher can not find space.
+	/// It tries to reclaim fragmented space by merging adjacent free areas.
+	/// @returns true if free areas could be merged, false if no adjacent areas exist
+	virtual	 bool	  reclaim();
+
+	virtual  void	updateStats();	///< update resource map statistics
+};
+
+#endif	/*WorstFit_h*/
+// vim:sw=4:ai:aw:ts=4:
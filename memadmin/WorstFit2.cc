@@ -0,0 +1,40 @@
+/** @file WorstFit2.cc
+ * De implementatie van WorstFit2.
+ */
+
+#include "WorstFit2.h"
+
+
+// Iemand levert een gebied weer in (eager version)
+void	WorstFit2::free(Area *ap)
+{
+	require(ap != 0);
+	taken(ap);						// the sanity check (in check mode only)
+
+	// Is the area directly after ap free ?
+	int  after = ap->getBase() + ap->getSize();
+	if ((after < size) && heads[after]) {
+		Area  *bp = heads[after];
+		leave(bp);
+		ap->join(bp);					// append area bp to ap (and destroy bp)
+		++mergers;						// update statistics
+	}
+	// Is the area directly before ap free ?
+	if ((ap->getBase() > 0) && tails[ap->getBase() - 1]) {
+		Area  *bp = tails[ap->getBase() - 1];
+		leave(bp);
+		bp->join(ap);					// append area ap to bp (and destroy ap)
+		++mergers;						// update statistics
+		ap = bp;						// now pretend this is the free'd area
+	}
+	enter(ap);							// NB the old heap entry of bp is now stale
+}
+
+// Nothing to reclaim when the neighbours are always merged immediately
+bool	WorstFit2::reclaim()
+{
+	++reclaims;	// update statistics ("reclaims attempted")
+	return false;
+}
+
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,40 @@
+#pragma once
+#ifndef	__WorstFit2_h__
+#define	__WorstFit2_h__	1.0
+
+/** @file WorstFit2.h
+ *  @brief The class that implements the eager version of the WorstFit algorithm.
+ */
+
+#include "WorstFit.h"
+
+
+/// @class WorstFit2
+/// Het WorstFit algorithme gebruikt altijd het grootste vrije gebied.
+/// Dit is de eager versie: een teruggegeven gebied wordt meteen met
+/// zijn vrije buren samengevoegd. Die buren worden via de "boundary tags"
+/// van WorstFit (heads en tails, per adres) in O(1) gevonden.
+class	WorstFit2 : public WorstFit
+{
+public:
+
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	/// @param cflag	initial status of check-mode
+	/// @param type		name of this algorithm (default=WorstFit2)
+	WorstFit2(bool cflag, const char *type = "WorstFit (eager)")
+		: WorstFit(cflag, type) {}
+
+	/// The application returns an area to freespace
+	/// @param ap	The area returned to free space
+	virtual  void	 free(Area *ap);
+
+protected:
+
+	/// Every area is merged when it is free'd,
+	/// so there is never anything left to reclaim.
+	virtual	 bool	 reclaim();
+
+};
+
+#endif	/*WorstFit2_h*/
+// vim:sw=4:ai:aw:ts=4:
@@ -0,0 +1,43 @@
+#pragma once
+#ifndef	__Wrapper_h__
+#define	__Wrapper_h__	1.0
+
+/** @file Wrapper.h
+ *  @brief The baseclass for allocators that pass everything on to another allocator.
+ */
+
+#include "Allocator.h"
+
+
+/// @class Wrapper
+/// Een Wrapper is een allocator die zelf geen geheugen beheert maar
+/// alle aanvragen doorgeeft aan een andere ("inner") allocator,
+/// en er onderweg iets mee doet: opnemen, meten, enz.
+/// Een afgeleide class hoeft alleen te herdefinieren wat hij anders doet.
+/// De naam is die van de inner allocator, zodat de rapportage klopt.
+class	Wrapper : public Allocator
+{
+public:
+
+	/// @param inner	the allocator that does the real work (is deleted by us)
+	explicit	// see: http://en.cppreference.com/w/cpp/language/explicit
+	Wrapper(Allocator *inner)
+		: Allocator(false, inner->getType()), inner(inner) {}
+
+	~Wrapper()	{ delete inner; }		///< cleanup the inner allocator
+
+	/// Initialize the memory size, of both of us
+	void	 setSize(int new_size)	{ Allocator::setSize(new_size); inner->setSize(new_size); }
+
+	Area	*alloc(int wanted)	{ return inner->alloc(wanted); }	///< pass on
+	void	 free(Area *ap)		{ inner->free(ap); }				///< pass on
+	void	 report()			{ inner->report(); }				///< pass on
+	bool	 freeSpace(FreeSpace& fs)	{ return inner->freeSpace(fs); }	///< pass on
+
+protected:
+
+	Allocator	*inner;		///< the real allocator
+};
+
+#endif	/*Wrapper_h*/
+// vim:sw=4:ai:aw:ts=4:
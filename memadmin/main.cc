@@ -9,6 +9,9 @@
 #include <cstdlib>	// exit(2), atexit(3), atol(3), EXIT_SUCCESS, EXIT_FAILURE
 #include <getopt.h>	// int getopt(3) en char *optarg
 #include <unistd.h>
+#include <cstring>	// strchr(3), strlen(3)
+#include <string>	// std::string
+#include <vector>	// the STL std::vector<> container
 // Zie ook manuals: signal(2), exit(3), atol(3) en getopt(3)
 #if defined(__MINGW_H)
 # include <process.h>	// A non-standard include for: getpid(2)
@@ -29,13 +32,19 @@
 // .... voeg hier je eigen variant(en) toe ....
 // bijvoorbeeld:
 #include "BestFit.h"		// pas de naam aan aan jouw versie
+#include "SegregatedFit.h"	// de FirstFit allocator met size classes
+#include "TreeBestFit.h"	// de BestFit allocator met een gesorteerde boom
+#include "ArrayFit.h"		// de fit allocators met een array als resource map
 //#include "BestFit2.h"		// pas de naam aan aan jouw versie
-//#include "WorstFit.h"		// pas de naam aan aan jouw versie
-//#include "WorstFit2.h"		// pas de naam aan aan jouw versie
+#include "WorstFit.h"		// de WorstFit allocator (lazy) met een heap
+#include "WorstFit2.h"		// de WorstFit allocator (eager) met een heap
 //#include "PowerOfTwo.h"	// pas de naam aan aan jouw versie
-//#include "McKusickK.h"	// pas de naam aan aan jouw versie
-//#include "Buddy.h"		// pas de naam aan aan jouw versie
+#include "McKusickK.h"	// de McKusick-Karels allocator
+#include "Buddy.h"		// de binary buddy allocator
+#include "TLSF.h"		// de two-level segregated fit allocator
+#include "Factory.h"		// alle algoritmes bij naam (o.a. de template versies)
 //enz
+#include "Benchmark.h"	// alle allocators in een keer meten
 
 
 // ===================================================================
@@ -53,6 +62,42 @@ bool		  tflag = false;		///< 'true' als we de code willen "testen"
 bool		  vflag = false;		///< vertel wat er gebeurt
 bool		  cflag = false;		///< laat de allocator foute 'free' acties detecteren
 ///< (voor sommige algorithmes is dit duur)
+bool		  iflag = false;		///< laat de eager allocators boundary tags gebruiken
+bool		  yflag = false;		///< gebruik de template versies van de fit allocators
+const char	 *ofile = 0;			///< schrijf een trace van alle allocs en frees naar deze file
+const char	 *rfile = 0;			///< speel deze trace af i.p.v. een scenario
+int			  herhaal = 0;			///< benchmark: zo vaak elke meting herhalen (0=geen benchmark)
+bool		  jflag = false;		///< benchmark: JSON i.p.v. CSV uitvoer
+bool		  lflag = false;		///< meet de latency van elke alloc en free
+int		  fragEvery = 0;		///< meet de fragmentatie om de zoveel operaties (0=niet)
+int		  fragSmall = 16;		///< vrije gebieden kleiner dan dit zijn onbruikbaar
+int		  threads = 0;			///< meet met 1 .. zoveel threads (0=niet)
+bool		  kflag = true;			///< threads gebruiken een eigen cache
+int		  shards = 0;			///< verdeel het geheugen over zoveel arena's (0=niet)
+int		  unitBytes = 0;		///< echt geheugen: zoveel bytes per eenheid (0=niet)
+int		  quickMax = 0;			///< quick lists voor de omvang 1 .. zoveel (0=niet)
+int		  quickPercent = 10;	///< quick lists leeg maken boven zoveel % van het geheugen
+const char	 *gspec = 0;			///< -G: de beschrijving van een werklast (zie Workload.h)
+int			  batch = 0;			///< -K: vraag en geef geheugen per request van max zoveel objecten (0=niet)
+std::vector<std::string>	convert;	///< -C: raw trace, trace en bytes per eenheid
+std::vector<int>	sizes;			///< benchmark: alle -s waardes
+std::vector<int>	aantallen;		///< benchmark: alle -a waardes
+std::vector<std::string>	scenarios;	///< benchmark: de -S scenarios
+
+
+/// Zet een lijst zoals "100,200,300" om in getallen.
+/// @returns	het eerste getal
+int		parseList(const char *arg, std::vector<int>& list)
+{
+    list.clear();
+    for (const char *p = arg ; p ; p = strchr(p, ','))
+    {
+        if (*p == ',')
+            ++p;
+        list.push_back(atol(p));
+    }
+    return list.front();
+}
 
 
 /// Vertel welke opties dit programma kent
@@ -62,11 +107,29 @@ void	tellOptions(const char *progname)
          AS_UNDERLINE"options"AA_RESET ", valid options are:" << endl;
 
     // Algemeen
-    cout << "\t-s size\t\tsize of memory being administrated\n";
-    cout << "\t-a count\tnumber of actions (current=" << aantal << ")\n";
+    cout << "\t-s size[,size..]\tsize of memory being administrated\n";
+    cout << "\t-a count[,count..]\tnumber of actions (current=" << aantal << ")\n";
     cout << "\t-t\t\ttoggle test mode (current=" << (tflag ? "on" : "off") << ")\n";
     cout << "\t-v\t\ttoggle verbose mode (current=" << (vflag ? "on" : "off") << ")\n";
     cout << "\t-c\t\ttoggle check mode (current=" << (cflag ? "on" : "off") << ")\n";
+    cout << "\t-i\t\ttoggle indexed coalescing for -F, -N and -B (current=" << (iflag ? "on" : "off") << ")\n";
+    cout << "\t-Y\t\ttoggle the template versions of -f -F -n -N -b (current=" << (yflag ? "on" : "off") << ")\n";
+    cout << "\t-P\t\ttoggle pooled Area descriptors and list nodes (current=" << (Pool::isEnabled() ? "on" : "off") << ")\n";
+    cout << "\t-L\t\ttoggle latency histograms for alloc and free (current=" << (lflag ? "on" : "off") << ")\n";
+    cout << "\t-D K[,min]\tsample the fragmentation every K operations, areas < min are unusable\n";
+    cout << "\t-j N\t\tmeasure the throughput with 1 upto N threads\n";
+    cout << "\t-k\t\ttoggle the per-thread caches for -j, not with -L -D -X -o (current=" << (kflag ? "on" : "off") << ")\n";
+    cout << "\t-Z K\t\tsplit the memory into K per-core arenas of the chosen algorithm (not with -t)\n";
+    cout << "\t-q max[,pct]\tquick lists for sizes upto max, flushed above pct% of memory (current=" << quickPercent << ")\n";
+    cout << "\t-X bytes\tback the memory with real memory, this many bytes per unit\n";
+    cout << "\t-C raw,file[,bytes]\tconvert a raw malloc trace (see preload/) into a trace\n";
+    cout << "\t-G spec|@file\trun a workload, e.g. size=zipf:1:100:1.2,life=exp:500,seed=7\n";
+    cout << "\t-K n\t\talloc and free per request of upto n areas at once (allocBatch/freeBatch)\n";
+    cout << "\t-o file\t\trecord a trace of all allocs and frees in file\n";
+    cout << "\t-R file\t\treplay the trace in file instead of a scenario\n";
+    cout << "\t-M reps\t\tbenchmark all allocators, all sizes and counts, reps times each\n";
+    cout << "\t-S name,..\tbenchmark these scenarios (random, servlets, batches; default all)\n";
+    cout << "\t-J\t\ttoggle JSON instead of CSV benchmark output (current=" << (jflag ? "on" : "off") << ")\n";
 
     // De fitter groep
     cout << "\t-r\t\tuse the random allocator\n";
@@ -75,14 +138,18 @@ void	tellOptions(const char *progname)
     cout << "\t-n\t\tuse the next fit allocator (lazy)\n";
     cout << "\t-N\t\tuse the next fit allocator (eager)\n";
     cout << "\t-b\t\tuse the best fit allocator (lazy)\n";
-    //cout << "\t-B\t\tuse the best fit allocator (eager)\n";
-    //cout << "\t-w\t\tuse the worst fit allocator (lazy)\n";
-    //cout << "\t-W\t\tuse the worst fit allocator (eager)\n";
+    cout << "\t-g\t\tuse the first fit allocator with segregated size classes (lazy)\n";
+    cout << "\t-T\t\tuse the best fit allocator on a size ordered tree (lazy)\n";
+    cout << "\t-A f|n|b\tuse the first/next/best fit allocator on an array map (eager)\n";
+    cout << "\t-B\t\tuse the best fit allocator (eager, a template version only)\n";
+    cout << "\t-w\t\tuse the worst fit allocator (lazy)\n";
+    cout << "\t-W\t\tuse the worst fit allocator (eager)\n";
 
     // De power-of-2 groep
     //cout << "\t-p\t\tuse power of 2 allocator\n";
-    //cout << "\t-m\t\tuse mckusick/karols allocator\n";
-    //cout << "\t-2\t\tuse buddy algorithm\n";
+    cout << "\t-m\t\tuse mckusick/karels allocator\n";
+    cout << "\t-2\t\tuse buddy algorithm\n";
+    cout << "\t-l\t\tuse the two-level segregated fit allocator (eager)\n";
 
 }
 
@@ -91,7 +158,7 @@ void	tellOptions(const char *progname)
 /// Kan/zal diverse globale variabelen veranderen !
 void	doOptions(int argc, char *argv[])
 {
-    char  options[] = "s:a:tvcrfFnNb"; // De opties die we willen herkennen
+    char  options[] = "s:a:tvciYPLD:j:kZ:q:X:C:G:K:o:R:M:S:JrfFnNbBwWgTA:m2l"; // De opties die we willen herkennen
     //
     // Als je algoritmes toevoegt dan moet je de string hierboven uitbreiden.
     // (Vergeet niet tellOptions ook aan te passen)
@@ -105,6 +172,28 @@ void	doOptions(int argc, char *argv[])
     // "t"  staat voor: -t = code testen (i.p.v. performance meten)
     // "v"  staat voor: -v = verbose mode (vertel wat er gebeurt)
     // "c"  staat voor: -c = check mode (bewaak 'free' acties)
+    // "i"  staat voor: -i = indexed mode (boundary tags voor de eager allocators)
+    //                       (moet voor -F, -N of -B komen)
+    // "Y"  staat voor: -Y = de template versies van de fit allocators (zie PolicyFitter.h)
+    //                       (moet voor -f, -F, -n, -N of -b komen)
+    // "P"  staat voor: -P = pool mode (Area's en lijst nodes uit een Pool)
+    //                       (moet voor de keuze van de allocator komen)
+    // "L"  staat voor: -L = latency histogrammen voor alloc en free
+    // "D:" staat voor: -D K[,min] = fragmentatie meetreeks
+    // "j:" staat voor: -j N = meet met 1 .. N threads
+    // "k"  staat voor: -k = per-thread caches aan/uit
+    // "Z:" staat voor: -Z K = K arena's per core
+    // "q:" staat voor: -q max[,pct] = quick lists voor de kleine omvangen
+    // "X:" staat voor: -X bytes = echt geheugen achter de eenheden
+    // "C:" staat voor: -C raw,file[,bytes] = converteer een malloc trace
+    // "G:" staat voor: -G spec = een instelbare werklast
+    // "K:" staat voor: -K n = requests van max n objecten (allocBatch/freeBatch)
+    // "o:" staat voor: -o file = neem een trace op in deze file
+    // "R:" staat voor: -R file = speel de trace in deze file af
+    // "M:" staat voor: -M n = benchmark alle allocators, elke meting n keer
+    //                         (-s en -a mogen dan een lijst zijn: -s 1000,10000)
+    // "S:" staat voor: -S naam,... = de scenarios voor de benchmark
+    // "J"  staat voor: -J = JSON i.p.v. CSV uitvoer voor de benchmark
     //
     // Opties om een beheeralgoritme uit te kiezen ...
     // r  staat voor: -r = random-fit allocator
@@ -113,11 +202,16 @@ void	doOptions(int argc, char *argv[])
     // n  staat voor; -n = next-fit allocator (lazy)
     // N  staat voor; -N = next-fit allocator (eager)
     // b  staat voor; -b = best-fit allocator (lazy)
-    // B  staat voor; -b = best-fit allocator (eager)
+    // B  staat voor; -B = best-fit allocator (eager)
     // w  staat voor; -w = worst-fit allocator (lazy)
-    // W  staat voor; -w = worst-fit allocator (eager)
+    // W  staat voor; -W = worst-fit allocator (eager)
+    // g  staat voor; -g = first-fit allocator met size classes (lazy)
+    // T  staat voor; -T = best-fit allocator met een boom (lazy)
+    // A: staat voor; -A x = first(f), next(n) of best(b) fit met een array (eager)
     //  enz
+    // m  staat voor: -m = McKusick-Karels allocator
     // 2  staat voor: -2 = buddy allocator
+    // l  staat voor: -l = TLSF allocator
     //
     // Voor meer informatie, zie: man 3 getopt
     //
@@ -133,10 +227,10 @@ void	doOptions(int argc, char *argv[])
         {
         // ALGEMEEN
         case 's': // the size of the (imaginary) memory being managed
-            size = atol(optarg);   // atol = "ascii to long"
+            size = parseList(optarg, sizes);	// NB een lijst voor de benchmark
             break;
         case 'a': // the number of alloc/free actions
-            aantal = atol(optarg);
+            aantal = parseList(optarg, aantallen);
             break;
         case 't': // toggle test mode
             tflag = !tflag;
@@ -149,6 +243,102 @@ void	doOptions(int argc, char *argv[])
             if (beheerder)
                 beheerder->setCheck(cflag);
             break;
+        case 'i': // toggle indexed coalescing
+            require(beheerder == 0);   // must be known when the allocator is made
+            iflag = !iflag;
+            break;
+        case 'Y': // toggle the template versions
+            require(beheerder == 0);   // must be known when the allocator is made
+            yflag = !yflag;
+            break;
+        case 'P': // toggle pooled descriptors
+            require(beheerder == 0);   // nothing may be allocated yet
+            Pool::setEnabled(!Pool::isEnabled());
+            break;
+        case 'L': // toggle latency profiling
+            lflag = !lflag;
+            break;
+        case 'D': // fragmentation time series
+            {
+                std::vector<int>  args;
+                fragEvery = parseList(optarg, args);
+                if (args.size() > 1)
+                    fragSmall = args[1];
+            }
+            break;
+        case 'j': // multi-threaded scenario
+            threads = atol(optarg);
+            break;
+        case 'k': // toggle the per-thread caches
+            kflag = !kflag;
+            break;
+        case 'Z': // per-core arenas
+            shards = atol(optarg);
+            break;
+        case 'q': // quick lists
+            {
+                std::vector<int>  args;
+                quickMax = parseList(optarg, args);
+                require(quickMax > 0);
+                if (args.size() > 1)
+                    quickPercent = args[1];
+            }
+            break;
+        case 'X': // real memory
+            unitBytes = atol(optarg);
+            break;
+        case 'C': // convert a raw malloc trace
+            convert.clear();
+            for (const char *p = optarg ; *p ; )
+            {
+                const char  *e = strchr(p, ',');
+                if (!e)
+                    e = p + strlen(p);
+                convert.push_back(std::string(p, e));
+                p = *e ? e + 1 : e;
+            }
+            if (convert.size() < 2 || convert.size() > 3)
+            {
+                cerr << AC_RED "Oeps, -C wil: raw,file[,bytes]" AA_RESET "\n";
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'G': // workload generator
+            gspec = optarg;
+            break;
+        case 'K': // batches per request
+            batch = atol(optarg);
+            require(batch > 0);
+            break;
+        case 'o': // record a trace
+            ofile = optarg;
+            break;
+        case 'R': // replay a trace
+            rfile = optarg;
+            break;
+        case 'M': // benchmark mode
+            herhaal = atol(optarg);
+            require(herhaal > 0);
+            break;
+        case 'S': // benchmark scenarios
+            scenarios.clear();
+            for (const char *p = optarg ; *p ; )
+            {
+                const char  *q = strchr(p, ',');
+                std::string  name(p, q ? q : p + strlen(p));
+                if (!Benchmark::isScenario(name))
+                {
+                    cerr << AC_RED "Unknown scenario '" << name << "'" AA_RESET << endl;
+                    tellOptions(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                scenarios.push_back(name);
+                p = q ? q + 1 : p + strlen(p);
+            }
+            break;
+        case 'J': // toggle JSON output
+            jflag = !jflag;
+            break;
 
         // ALGORITMES
         case 'r': // -r = RandomFit allocator gevraagd
@@ -157,45 +347,94 @@ void	doOptions(int argc, char *argv[])
             break;
         case 'f': // -f = FirstFit allocator gevraagd (lazy)
             require(beheerder == 0);
-            beheerder = new FirstFit(cflag);
+            beheerder = yflag ? makeAllocator("Yf", cflag) : new FirstFit(cflag);
             break;
         case 'F': // -F = FirstFit allocator gevraagd (eager)
             require(beheerder == 0);
-            beheerder = new FirstFit2(cflag);
+            beheerder = yflag ? makeAllocator(iflag ? "YiF" : "YF", cflag) : new FirstFit2(cflag, iflag);
             break;
         case 'n': // -n = NextFit allocator gevraagd
             require(beheerder == 0);
-            beheerder = new NextFit(cflag);
+            beheerder = yflag ? makeAllocator("Yn", cflag) : new NextFit(cflag);
             break;
         case 'N': // -n = NextFit2 allocator gevraagd
             require(beheerder == 0);
-            beheerder = new NextFit2(cflag);
+            beheerder = yflag ? makeAllocator(iflag ? "YiN" : "YN", cflag) : new NextFit2(cflag, iflag);
             break;
         case 'b': // -b = BestFit allocator gevraagd
             require(beheerder == 0);
-            beheerder = new BestFit(cflag);
-            break;
-            /*
-            case 'B': // -B = BestFit2 allocator gevraagd
-            	require(beheerder == 0);
-            	beheerder = new BestFit2(cflag);
-            	break;
-            case 'w': // -w = WorstFit allocator gevraagd
-            	require(beheerder == 0);
-            	beheerder = new WorstFit(cflag);
-            	break;
-            case 'W': // -W = WorstFit2 allocator gevraagd
-            	require(beheerder == 0);
-            	beheerder = new WorstFit2(cflag);
-            	break;
-            	// enz
-            case '2':	// -2 = buddy allocator gevraagd
-            	require(beheerder == 0);
-            	beheerder = new ...(cflag);
-            	break;
-            */
+            beheerder = yflag ? makeAllocator("Yb", cflag) : new BestFit(cflag);
+            break;
+        case 'B': // -B = BestFit allocator gevraagd (eager)
+            require(beheerder == 0);
+            beheerder = makeAllocator(iflag ? "iB" : "B", cflag);
+            break;
+        case 'w': // -w = WorstFit allocator gevraagd
+            require(beheerder == 0);
+            beheerder = new WorstFit(cflag);
+            break;
+        case 'W': // -W = WorstFit2 allocator gevraagd
+            require(beheerder == 0);
+            beheerder = new WorstFit2(cflag);
+            break;
+        case 'g': // -g = SegregatedFit allocator gevraagd
+            require(beheerder == 0);
+            beheerder = new SegregatedFit(cflag);
+            break;
+        case 'T': // -T = TreeBestFit allocator gevraagd
+            require(beheerder == 0);
+            beheerder = new TreeBestFit(cflag);
+            break;
+        case 'A': // -A x = ArrayFit allocator gevraagd
+            require(beheerder == 0);
+            switch (*optarg)
+            {
+            case 'f':
+                beheerder = new ArrayFit(cflag, ArrayFit::FIRST);
+                break;
+            case 'n':
+                beheerder = new ArrayFit(cflag, ArrayFit::NEXT);
+                break;
+            case 'b':
+                beheerder = new ArrayFit(cflag, ArrayFit::BEST);
+                break;
+            default:
+                cerr << AC_RED "Unknown array policy '" << optarg << "'" AA_RESET << endl;
+                tellOptions(argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'm':	// -m = McKusick-Karels allocator gevraagd
+            require(beheerder == 0);
+            beheerder = new McKusickK(cflag);
+            break;
+        case '2':	// -2 = buddy allocator gevraagd
+            require(beheerder == 0);
+            beheerder = new Buddy(cflag);
+            break;
+        case 'l':	// -l = TLSF allocator gevraagd
+            require(beheerder == 0);
+            beheerder = new TLSF(cflag);
+            break;
+            // enz
 
         case -1: // = einde opties
+            // De test vraagt om al het geheugen in een keer,
+            // maar met arena's heeft geen enkele arena dat.
+            if (tflag && (shards > 0))
+            {
+                cerr << AC_RED "Options -t and -Z can not be combined" AA_RESET << endl;
+                tellOptions(argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            // Met de caches van -j zien de wrappers alleen de refills en
+            // flushes, en ze zijn niet thread-safe (dus niet erboven).
+            if ((threads > 0) && kflag && (lflag || (fragEvery > 0) || (unitBytes > 0) || ofile))
+            {
+                cerr << AC_RED "Options -L, -D, -X and -o would only see the refills of the -j caches, use -k too" AA_RESET << endl;
+                tellOptions(argv[0]);
+                exit(EXIT_FAILURE);
+            }
             return; // klaar met optie analyze
 
         default: // eh? iets onbekends gevonden (of zelf een case vergeten!)
@@ -263,6 +502,16 @@ void	waitForUserOke()
 // ===================================================================
 // #include "Application.h"	// De pseudo applicatie
 #include "FakeApplication.h" // De neppe applicatie
+#include "TraceRecorder.h"	// Een trace van alle allocs/frees opnemen
+#include "TraceReplay.h"	// en die weer afspelen
+#include "LatencyProfiler.h"	// De latency van elke alloc/free meten
+#include "FragMonitor.h"		// De fragmentatie volgen
+#include "ThreadedApplication.h"	// Met meerdere threads tegelijk
+#include "Sharded.h"			// Per-core arena's
+#include "Backing.h"			// Echt geheugen
+#include "QuickFit.h"			// Quick lists voor de kleine omvangen
+#include "TraceConverter.h"		// Traces van echte programma's
+#include "Workload.h"			// Instelbare werklasten
 
 
 
@@ -288,6 +537,35 @@ int  main(int argc, char *argv[])
         // neveneffect: zal diverse globale variabelen veranderen!
         doOptions(argc, argv);
 
+        // Een benchmark gebruikt alle allocators (zie Factory.cc)
+        if (herhaal > 0)
+        {
+            Benchmark  bench(herhaal, jflag);
+            if (sizes.empty())
+                sizes.push_back(size);
+            if (aantallen.empty())
+                aantallen.push_back(aantal);
+            for (size_t i = 0 ; i < sizes.size() ; ++i)
+                bench.addSize(sizes[i]);
+            for (size_t i = 0 ; i < aantallen.size() ; ++i)
+                bench.addCount(aantallen[i]);
+            for (size_t i = 0 ; i < scenarios.size() ; ++i)
+                bench.addScenario(scenarios[i].c_str());
+            bench.run(cout);
+            delete  beheerder;		// als er toch een gekozen was
+            return EXIT_SUCCESS;
+        }
+
+        // Een raw malloc trace converteren ?
+        if (!convert.empty())
+        {
+            TraceConverter  conv(convert[0].c_str());
+            conv.convert(convert[1].c_str(), (convert.size() > 2) ? atol(convert[2].c_str()) : 16);
+            conv.report();
+            delete  beheerder;		// als er toch een gekozen was
+            return EXIT_SUCCESS;
+        }
+
         // Is er wel een geheugen-beheerder module gekozen ?
         if (!beheerder)
         {
@@ -297,12 +575,91 @@ int  main(int argc, char *argv[])
             exit(EXIT_FAILURE);
         }
 
+        // Moet het geheugen over arena's verdeeld worden ?
+        // Dan maken we er nog meer van hetzelfde algoritme (zie Factory.cc)
+        Sharded  *sharded = 0;
+        if (shards > 0)
+        {
+            const AllocatorEntry  *e = findAllocator(beheerder->getType());
+            check(e != 0);
+            beheerder = sharded = new Sharded(beheerder, e->make, shards, cflag);
+        }
+
+        // Moeten de kleine omvangen uit quick lists komen ?
+        if (quickMax > 0)
+        {
+            beheerder = new QuickFit(beheerder, quickMax, quickPercent, cflag);
+        }
+
+        // Moet er echt geheugen achter ?
+        if (unitBytes > 0)
+        {
+            beheerder = new Backing(beheerder, unitBytes);
+        }
+
+        // Moeten we de fragmentatie volgen ?
+        if (fragEvery > 0)
+        {
+            beheerder = new FragMonitor(beheerder, fragEvery, fragSmall);
+        }
+
+        // Moeten we de latencies meten ?
+        if (lflag)
+        {
+            beheerder = new LatencyProfiler(beheerder);
+        }
+
+        // Moeten we een trace opnemen ?
+        // Dan gaan alle aanvragen via een TraceRecorder.
+        if (ofile)
+        {
+            beheerder = new TraceRecorder(beheerder, ofile);
+        }
+
+        // Met meerdere threads gaat alles via een ThreadCache.
+        // Alleen als die direct voor de Sharded staat mag zijn lock weg:
+        // de andere wrappers (-q -X -D -L -o) zijn niet thread-safe, en de
+        // Pool van de Area's en lijst nodes (-P) ook niet.
+        ThreadCache  *cache = 0;
+        if (threads > 0)
+        {
+            bool  serialize = (beheerder != sharded) || Pool::isEnabled();
+            beheerder = cache = new ThreadCache(beheerder, kflag, serialize);
+        }
+
         // Omvang van het beheerde geheugen controleren
         check(size > 0);
 
         // Vertel het aan de geheugen-beheerder ...
         beheerder->setSize(size);
 
+        if (cache)      // De -j optie gezien ?
+        {
+            cerr << AC_BLUE "Measuring " << beheerder->getType() << " with 1 upto " << threads
+                 << " threads doing " << aantal << " calls on " << size << " units\n" AA_RESET;
+            ThreadedApplication  app(cache, size);
+            app.scaling(threads, aantal);
+            beheerder->report();
+            delete  beheerder;
+            return EXIT_SUCCESS;
+        }
+
+        if (rfile)      // De -R optie gezien ?
+        {
+            // Speel een opgenomen trace af i.p.v. een scenario
+            TraceReplay  replay(rfile);
+            if (replay.getSize() != size)
+            {
+                cerr << AC_RED "NB the trace was recorded with " << replay.getSize()
+                     << " units" AA_RESET "\n";
+            }
+            cerr << AC_BLUE "Replaying " << rfile << " on " << beheerder->getType()
+                 << " doing " << replay.getCount() << " calls on " << size << " units\n" AA_RESET;
+            replay.run(beheerder);
+            delete  beheerder;
+            return EXIT_SUCCESS;
+        }
+
         // ... en maak dan de pseudo-applicatie
         // Application  *mp = new Application(beheerder, size);
         FakeApplication *fakeApp = new FakeApplication(beheerder, size);
@@ -326,7 +683,19 @@ int  main(int argc, char *argv[])
             }
             cerr << AC_BLUE "Measuring " << beheerder->getType()
                  << " doing " << aantal << " calls on " << size << " units\n" AA_RESET;
-            fakeApp->minderRandomScenario(aantal, vflag);
+            if (gspec)
+            {
+                Workload  w(gspec);
+                fakeApp->workloadScenario(w, aantal, vflag);
+            }
+            else if (batch > 0)
+            {
+                fakeApp->batchScenario(aantal, batch, vflag);
+            }
+            else
+            {
+                fakeApp->minderRandomScenario(aantal, vflag);
+            }
             /// .. vervang straks 'randomscenario' door iets toepasselijkers
             /// zodat je ook voorspelbare scenarios kan afhandelen.
         }
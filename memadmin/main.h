@@ -24,10 +24,11 @@ using namespace std;
 #include "ansi.h"		// ansi color codes
 #include "Area.h"		// class Area
 #include "Allocator.h"	// baseclass Allocator
+#include "Pool.h"		// class PoolAllocator
 
 
 // Even wat handige afkortingen maken ...
-typedef	std::list<Area*>	AreaList;		///< Een "Arealist container"
+typedef	std::list<Area*, PoolAllocator<Area*> >	AreaList;	///< Een "Arealist container"
 typedef	AreaList::iterator	ALiterator;		///< Een "AreaList container Iterator"
 
 
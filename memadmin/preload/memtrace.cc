@@ -0,0 +1,228 @@
+/** @file memtrace.cc
+ * Een LD_PRELOAD bibliotheek die van een willekeurig (ongewijzigd)
+ * programma alle malloc's en free's opneemt in een "raw" trace.
+ *
+ * Gebruik:
+ * @code
+ *	make preload
+ *	MEMTRACE=/tmp/web.raw LD_PRELOAD=$PWD/preload/libmemtrace.so programma ...
+ *	./main -C /tmp/web.raw,/tmp/web.tr,16
+ *	./main -R /tmp/web.tr -b
+ * @endcode
+ * Zonder MEMTRACE heet de trace memtrace.<pid>.raw.
+ *
+ * Elke thread schrijft in een eigen buffer, zonder locks. Een volle
+ * buffer gaat op een lock-free stack; een aparte thread haalt die
+ * stack in een keer leeg en schrijft de buffers weg.
+ * De echte allocator is die van glibc (__libc_malloc c.s.).
+ * Allocaties met memalign, posix_memalign of aligned_alloc worden niet
+ * opgenomen; de converter slaat hun free's over.
+ *
+ * NB Dit is geen deel van 'main': de makefile bouwt het apart.
+ */
+
+#include <cstddef>		// size_t
+#include <cstdio>		// snprintf(3)
+#include <cstdlib>		// getenv(3)
+#include <cstring>		// memcpy(3)
+#include <fcntl.h>		// open(2)
+#include <unistd.h>		// write(2), close(2), getpid(2), usleep(3)
+#include <pthread.h>	// pthread_create(3), pthread_key_create(3)
+#include <time.h>		// clock_gettime(2)
+#include "../Trace.h"
+
+extern "C" {
+	void	*__libc_malloc(size_t);
+	void	*__libc_calloc(size_t, size_t);
+	void	*__libc_realloc(void *, size_t);
+	void	 __libc_free(void *);
+}
+
+
+namespace {
+
+enum { BUFRECS = 4096 };		// records per buffer
+
+/// The private buffer of one thread
+struct	Buffer {
+	Buffer		*next;			// on the stack of full buffers
+	unsigned	 count;
+	MallocRecord rec[BUFRECS];
+};
+
+enum { OFF, ON, DONE };
+volatile int	state = OFF;	// are we recording ?
+int				fd = -1;		// the raw trace
+Buffer *volatile	full = 0;	// the lock-free stack of full buffers
+unsigned		threads = 0;	// threads seen so far
+pthread_key_t	key;			// to catch the exit of a thread
+pthread_t		flusher;		// writes the full buffers
+
+// NB initial-exec: the thread-locals must not be malloc'ed themselves
+#define	TLS	__thread __attribute__((tls_model("initial-exec")))
+TLS Buffer		*current = 0;	// the buffer of this thread
+TLS unsigned	 thread = 0;	// the number of this thread
+TLS int			 busy = 0;		// prevents recursion (e.g. inside pthread_setspecific)
+
+
+// Push a buffer on the stack (any thread)
+void	push(Buffer *b)
+{
+	do {
+		b->next = full;
+	} while (!__sync_bool_compare_and_swap(&full, b->next, b));
+}
+
+// Take all buffers from the stack and write them (only the flusher, and at exit)
+void	drain()
+{
+	Buffer  *b = __sync_lock_test_and_set(&full, (Buffer*)0);
+	Buffer  *fifo = 0;			// reverse: oldest first
+	while (b) {
+		Buffer  *n = b->next;
+		b->next = fifo;
+		fifo = b;
+		b = n;
+	}
+	while (fifo) {
+		Buffer  *n = fifo->next;
+		if (write(fd, fifo->rec, fifo->count * sizeof(MallocRecord)) < 0)
+			;					// nothing we can do about it
+		__libc_free(fifo);
+		fifo = n;
+	}
+}
+
+// The flusher thread
+void	*flushLoop(void *)
+{
+	while (state == ON) {
+		usleep(10000);
+		drain();
+	}
+	return 0;
+}
+
+// A thread exits: its last records go too
+void	threadGone(void *p)
+{
+	Buffer  *b = static_cast<Buffer*>(p);
+	if (b == current)
+		current = 0;
+	if (b->count > 0)
+		push(b);
+	else
+		__libc_free(b);
+}
+
+// Add one record to the buffer of this thread
+void	record(TraceOp op, void *ptr, size_t size)
+{
+	if (state != ON || busy)
+		return;
+	busy = 1;
+	if (!thread)
+		thread = __sync_add_and_fetch(&threads, 1);
+	Buffer  *b = current;
+	if (!b) {
+		b = current = static_cast<Buffer*>(__libc_malloc(sizeof(Buffer)));
+		if (!b) {
+			busy = 0;
+			return;
+		}
+		b->count = 0;
+		pthread_setspecific(key, b);
+	}
+	struct timespec  ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	MallocRecord&  r = b->rec[b->count];
+	r.time = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	r.ptr = (uint64_t)ptr;
+	r.size = size;
+	r.thread = thread;
+	r.op = op;
+	if (++b->count == BUFRECS) {
+		current = 0;			// the next record gets a new buffer
+		pthread_setspecific(key, 0);
+		push(b);
+	}
+	busy = 0;
+}
+
+// Start recording when the library is loaded
+__attribute__((constructor))
+void	start()
+{
+	char  name[64];
+	const char  *path = getenv("MEMTRACE");
+	if (!path) {
+		snprintf(name, sizeof(name), "memtrace.%d.raw", int(getpid()));
+		path = name;
+	}
+	fd = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+	if (fd < 0)
+		return;
+	MallocHeader  h;
+	memcpy(h.magic, MALLOC_MAGIC, sizeof(h.magic));
+	h.version = MALLOC_VERSION;
+	if (write(fd, &h, sizeof(h)) != sizeof(h))
+		return;
+	pthread_key_create(&key, threadGone);
+	state = ON;
+	if (pthread_create(&flusher, 0, flushLoop, 0) != 0)
+		state = OFF;
+}
+
+// Stop recording and write what is left
+__attribute__((destructor))
+void	stop()
+{
+	if (state != ON)
+		return;
+	state = DONE;
+	pthread_join(flusher, 0);
+	if (current && current->count > 0) {
+		push(current);
+		current = 0;
+	}
+	drain();
+	close(fd);
+}
+
+}	// namespace
+
+
+// ----- the interposed functions -----
+
+extern "C" void	*malloc(size_t size)
+{
+	void  *p = __libc_malloc(size);
+	record(p ? TRACE_ALLOC : TRACE_FAIL, p, size);
+	return p;
+}
+
+extern "C" void	*calloc(size_t n, size_t size)
+{
+	void  *p = __libc_calloc(n, size);
+	record(p ? TRACE_ALLOC : TRACE_FAIL, p, n * size);
+	return p;
+}
+
+extern "C" void	*realloc(void *old, size_t size)
+{
+	if (old)
+		record(TRACE_FREE, old, 0);		// NB before another thread can get it
+	void  *p = __libc_realloc(old, size);
+	if (size > 0)
+		record(p ? TRACE_ALLOC : TRACE_FAIL, p, size);
+	return p;
+}
+
+extern "C" void	free(void *p)
+{
+	if (p)
+		record(TRACE_FREE, p, 0);		// NB before another thread can get it
+	__libc_free(p);
+}
+
+// vim:sw=4:ai:aw:ts=4: